@@ -1,12 +1,25 @@
 #include "Activeobject.hpp"
 #include <iostream>
 
-ActiveObject::ActiveObject(int numThreads) : running(true), cancelingTasks(false)
+// The pool and worker index of the calling thread (null and -1 outside every pool)
+static thread_local ActiveObject *currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+ActiveObject::ActiveObject(int numThreads, Scheduling scheduling)
+    : scheduling(scheduling), sleeping(0), waiters(0), running(true), cancelingTasks(false)
 {
+    if (scheduling == WORK_STEALING)
+    {
+        for (int i = 0; i < numThreads; ++i)
+        {
+            deques.emplace_back(new WorkStealingDeque());
+        }
+    }
+
     // Launch the specified number of worker threads
     for (int i = 0; i < numThreads; ++i)
     {
-        workers.emplace_back(&ActiveObject::workerThread, this);
+        workers.emplace_back(&ActiveObject::workerThread, this, i);
     }
 }
 
@@ -15,20 +28,126 @@ ActiveObject::~ActiveObject()
     shutdown(); // Ensure that the threads are properly shut down
 }
 
-// Enqueue tasks to the task queue
+// Enqueue tasks to the task queue, or to the calling worker's own deque
 void ActiveObject::enqueueTask(std::function<void()> task)
 {
+    tryEnqueue(task);
+}
+
+// Enqueue a task unless the pool is shutting down
+bool ActiveObject::tryEnqueue(std::function<void()> &task)
+{
+    if (scheduling == WORK_STEALING && currentPool == this)
+    {
+        // Spawned by one of our tasks: no lock, unless a worker sleeps and must be woken up to steal it
+        deques[currentWorker]->push(new std::function<void()>(std::move(task)));
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the sleeper's check in workerThread()
+        if (sleeping.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            cv.notify_one();
+        }
+        return true;
+    }
+
     std::unique_lock<std::mutex> lock(mtx);
-    if (running && !cancelingTasks)
-    { // Only enqueue tasks if running and not in shutdown
-        tasks.push(std::move(task));
-        cv.notify_one(); // Notify one waiting thread that a new task is available
+    if (!running || cancelingTasks)
+    {
+        return false; // Only enqueue tasks if running and not in shutdown
+    }
+    tasks.push(std::move(task));
+    cv.notify_one(); // Notify one waiting thread that a new task is available
+    return true;
+}
+
+// Enqueue a task that decrements pending once it has run
+void ActiveObject::spawn(std::atomic<int> &pending, std::function<void()> task)
+{
+    pending.fetch_add(1);
+    std::function<void()> counted = [&pending, task = std::move(task)]()
+    {
+        task();
+        pending.fetch_sub(1);
+    };
+    if (!tryEnqueue(counted))
+    {
+        counted(); // Refused: run it here, or pending would never drop to 0
+    }
+}
+
+// Wait until pending drops to 0; a worker keeps running tasks meanwhile instead of blocking its thread
+void ActiveObject::waitFor(std::atomic<int> &pending)
+{
+    if (!isWorkerThread())
+    {
+        waiters.fetch_add(1); // Before checking pending, so runTask() cannot miss us
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneCV.wait(lock, [&pending]()
+                        { return pending.load() == 0; });
+        }
+        waiters.fetch_sub(1);
+        return;
+    }
+
+    while (pending.load() > 0)
+    {
+        if (!runPendingTask())
+        {
+            std::this_thread::yield(); // The rest of the group is running on other workers
+        }
     }
 }
 
+// Run one pending task on the calling thread
+bool ActiveObject::runPendingTask()
+{
+    std::function<void()> task;
+    if (!takeTask(currentPool == this ? currentWorker : -1, task))
+    {
+        return false;
+    }
+    runTask(task);
+    return true;
+}
+
+// Check whether the calling thread is one of our workers
+bool ActiveObject::isWorkerThread() const
+{
+    return currentPool == this;
+}
+
 // Worker thread function that processes tasks
-void ActiveObject::workerThread()
+void ActiveObject::workerThread(int index)
 {
+    currentPool = this;
+    currentWorker = index;
+
+    if (scheduling == WORK_STEALING)
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            if (takeTask(index, task))
+            {
+                runTask(task);
+                continue;
+            }
+
+            // Nothing to run or steal: sleep until a task is enqueued or pushed to a deque, or shutdown
+            std::unique_lock<std::mutex> lock(mtx);
+            sleeping.fetch_add(1); // Before checking the deques, so enqueueTask() cannot miss us
+            cv.wait(lock, [this]()
+                    { return !tasks.empty() || !running || cancelingTasks || anyStealable(); });
+            sleeping.fetch_sub(1);
+            if (!running || cancelingTasks)
+            {
+                break;
+            }
+        }
+        return;
+    }
+
     while (true)
     {
         std::function<void()> task;
@@ -53,11 +172,96 @@ void ActiveObject::workerThread()
         // Execute the task outside of the locked section
         if (task)
         {
-            task();
+            runTask(task);
+        }
+    }
+}
+
+// Helper function to steal the oldest task of another worker's deque (the biggest piece of a recursive split),
+// trying the victims from a random one on so that the thieves spread out. Null if every deque was empty
+static WorkStealingDeque::Task *stealFrom(std::vector<std::unique_ptr<WorkStealingDeque>> &deques, int thief)
+{
+    static thread_local unsigned int seed = 0x9e3779b9u ^ static_cast<unsigned int>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    size_t count = deques.size();
+    if (count == 0)
+    {
+        return nullptr;
+    }
+    size_t start = seed % count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t victim = (start + i) % count;
+        if (static_cast<int>(victim) == thief)
+        {
+            continue;
+        }
+        WorkStealingDeque::Task *task = deques[victim]->steal();
+        if (task)
+        {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+// Take a task: the newest of our own deque, a stolen one, or the oldest of the shared queue
+bool ActiveObject::takeTask(int index, std::function<void()> &task)
+{
+    WorkStealingDeque::Task *taken = nullptr;
+    if (scheduling == WORK_STEALING)
+    {
+        if (index >= 0)
+        {
+            taken = deques[index]->pop();
+        }
+        if (!taken)
+        {
+            taken = stealFrom(deques, index);
+        }
+        if (taken)
+        {
+            task = std::move(*taken);
+            delete taken;
+            return true;
         }
     }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!running || cancelingTasks || tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(tasks.front());
+    tasks.pop();
+    return true;
 }
 
+// Check whether any worker's deque holds a task
+bool ActiveObject::anyStealable() const
+{
+    for (const std::unique_ptr<WorkStealingDeque> &deque : deques)
+    {
+        if (!deque->empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Run a task, then wake up the threads in waitFor() (only if there are any: no lock otherwise)
+void ActiveObject::runTask(std::function<void()> &task)
+{
+    task();
+    if (waiters.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        doneCV.notify_all();
+    }
+}
 
 // Shut down all worker threads gracefully
 void ActiveObject::shutdown()
@@ -1,7 +1,10 @@
 #ifndef ACTIVEOBJECT_HPP
 #define ACTIVEOBJECT_HPP
 
+#include "WorkStealingDeque.hpp"
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <thread>
 #include <vector>
 #include <queue>
@@ -11,34 +14,81 @@
 class ActiveObject
 {
 public:
+    // How the tasks reach the worker threads
+    enum Scheduling
+    {
+        SHARED_QUEUE, // One FIFO queue under one lock, for independent tasks such as the clients' commands
+        WORK_STEALING // A Chase-Lev deque per worker: a task spawned by a worker is pushed to its own deque
+                      // without locking, and idle workers steal from the others. For recursive parallel work
+    };
+
     // Constructor to initialize the thread pool with a given number of threads
-    ActiveObject(int numThreads);
+    ActiveObject(int numThreads, Scheduling scheduling = SHARED_QUEUE);
 
     // Destructor to ensure proper shutdown
     ~ActiveObject();
 
-    // Method to enqueue tasks into the task queue
+    // Method to enqueue tasks into the task queue (with WORK_STEALING, into the calling worker's own deque
+    // when the task is spawned by one of the pool's tasks)
     void enqueueTask(std::function<void()> task);
 
+    // Method to enqueue a task of a group counted by pending: pending is incremented now and decremented
+    // once the task has run, for waitFor(). A task the pool refuses (it is shutting down) runs right here
+    // instead, so that waitFor() still returns
+    void spawn(std::atomic<int> &pending, std::function<void()> task);
+
+    // Method to wait until pending drops to 0. One of the pool's workers runs other pending tasks meanwhile
+    // (its own deque's newest first, then stolen ones), so a task may wait for the tasks it spawned; it only
+    // yields while the last tasks of the group run elsewhere. Any other thread sleeps
+    void waitFor(std::atomic<int> &pending);
+
+    // Method to run one pending task on the calling thread; returns false if there was none
+    bool runPendingTask();
+
+    // Method to check whether the calling thread is one of the pool's workers
+    bool isWorkerThread() const;
 
     // Method to gracefully shut down all worker threads
     void shutdown();
 
 private:
     // Internal worker thread function that processes tasks
-    void workerThread();
+    void workerThread(int index);
+
+    // Internal function behind enqueueTask(): takes the task (moving from it) and returns true, or returns
+    // false and leaves it alone if the pool no longer accepts tasks
+    bool tryEnqueue(std::function<void()> &task);
 
+    // Internal function to take a task for the calling thread (worker index, or -1 for another thread): its
+    // own deque first, then a steal from the other workers' deques, then the shared queue. False if none
+    bool takeTask(int index, std::function<void()> &task);
+
+    // Internal function to check whether any worker's deque holds a task
+    bool anyStealable() const;
+
+    // Internal function to run a task taken by takeTask() and wake up the threads in waitFor()
+    void runTask(std::function<void()> &task);
 
     // Thread pool
     std::vector<std::thread> workers;
 
-    // Task queue
+    // Task queue (with WORK_STEALING, the tasks enqueued from outside the pool)
     std::queue<std::function<void()>> tasks;
 
+    // Work-stealing deques, one per worker (empty with SHARED_QUEUE)
+    Scheduling scheduling;
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    std::atomic<int> sleeping; // Workers waiting on cv, woken by a push to a deque only if there are any
+
     // Synchronization
     std::mutex mtx;
     std::condition_variable cv;
 
+    // Threads outside the pool in waitFor(), woken after each task only if there are any
+    std::mutex doneMutex;
+    std::condition_variable doneCV;
+    std::atomic<int> waiters;
+
     // Flags to control the running state and task cancelation
     bool running;        // Indicates whether the ActiveObject is still running
     bool cancelingTasks; // Indicates whether tasks are being canceled
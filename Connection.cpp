@@ -0,0 +1,507 @@
+#include "Connection.hpp"
+#include "Protocol.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <atomic>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Bytes read from the socket per read() call
+const size_t READ_CHUNK_SIZE = 16 * 1024;
+
+// Longest line accepted as a command; a client sending more without a newline is disconnected
+const size_t MAX_COMMAND_LENGTH = 64 * 1024;
+
+// Input a connection may hold before reading pauses: commands waiting to run plus the unterminated rest
+const size_t MAX_BUFFERED_INPUT = 1024 * 1024;
+
+// Bytes all connections together may hold for binary frames larger than MAX_BUFFERED_INPUT, which are read
+// whole; one more such frame is refused
+const size_t MAX_FRAME_BYTES_IN_FLIGHT = 256 * 1024 * 1024;
+
+// Bytes reserved for such frames, by all connections
+static std::atomic<size_t> frameBytesInFlight(0);
+
+// How long replies may wait for a client that does not read them, in total, before it is given up on
+const int SEND_TIMEOUT_MS = 5000;
+
+Connection::Connection(int fd)
+    : fd(fd), frameLength(0), frameReserved(0), queuedReserved(0), frameRejected(false), pendingBytes(0), scheduled(false), readPaused(false), readerParked(false),
+      inputClosed(false), suspended(false), stalled(false), waiting(false), woken(false), waitTimed(false),
+      suspensions(0), closing(false), output(fd)
+{
+}
+
+Connection::~Connection()
+{
+    frameBytesInFlight -= frameReserved + queuedReserved;
+    ::close(fd);
+}
+
+int Connection::getFd() const
+{
+    return fd;
+}
+
+Session &Connection::getSession()
+{
+    return session;
+}
+
+// Function to read until the socket has nothing more to give, or until enough input waits to be run
+Connection::ReadResult Connection::readAvailable()
+{
+    char buffer[READ_CHUNK_SIZE];
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (frameRejected)
+            {
+                input.clear(); // The rest of the refused frame, and whatever follows, is dropped
+            }
+            else if (input.size() + pendingBytes >= MAX_BUFFERED_INPUT)
+            {
+                cutCommands(); // The input may end in a binary frame that is allowed to be larger
+                if (input.size() + pendingBytes >= std::max(MAX_BUFFERED_INPUT, frameLength))
+                {
+                    readPaused = true; // runCommands() reports it once the queue is worked off
+                    return OPEN;
+                }
+            }
+        }
+
+        ssize_t bytesRead = ::read(fd, buffer, sizeof(buffer));
+        if (bytesRead > 0)
+        {
+            input.append(buffer, bytesRead);
+        }
+        else if (bytesRead == 0)
+        {
+            return PEER_CLOSED;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return OPEN;
+        }
+        else if (errno != EINTR)
+        {
+            return FAILED;
+        }
+    }
+}
+
+// Helper function to get the length of the binary payload announced by the line input[start, end): for the
+// lines of the binary frames (see Connection.hpp) with a record count in range, count * record size, else 0
+static size_t payloadLength(const std::string &input, size_t start, size_t end)
+{
+    struct Frame
+    {
+        const char *prefix; // First word of the line, with the space after it
+        int countField;     // Which number after the prefix is the record count (0 = the first)
+        size_t recordSize;  // Bytes per record
+        long long maxCount; // Largest record count accepted
+    };
+    static const Frame frames[] = {
+        {"upload ", 1, UPLOAD_RECORD_SIZE, MAX_UPLOAD_EDGES},
+        {"distances ", 0, PAIR_RECORD_SIZE, MAX_BATCH_PAIRS},
+    };
+
+    for (const Frame &frame : frames)
+    {
+        size_t prefixLength = std::strlen(frame.prefix);
+        if (end - start <= prefixLength || input.compare(start, prefixLength, frame.prefix) != 0)
+        {
+            continue;
+        }
+        // The line's own words only, parsed like the handler does: strtoll() would skip the "\n" and could
+        // take its count from the next line
+        Tokenizer args(input.data() + start + prefixLength, end - start - prefixLength);
+        long long count = 0;
+        for (int field = 0; field <= frame.countField; ++field)
+        {
+            if (!args.nextNumber(count))
+            {
+                return 0; // Missing or malformed count: the handler rejects the line
+            }
+        }
+        if (count <= 0 || count > frame.maxCount)
+        {
+            return 0; // The handler rejects the frame
+        }
+        return static_cast<size_t>(count) * frame.recordSize;
+    }
+    return 0;
+}
+
+// Helper function to reserve bytes of MAX_FRAME_BYTES_IN_FLIGHT; returns false when they are not left
+static bool reserveFrameBytes(size_t bytes)
+{
+    size_t held = frameBytesInFlight.load();
+    do
+    {
+        if (held + bytes > MAX_FRAME_BYTES_IN_FLIGHT)
+        {
+            return false;
+        }
+    } while (!frameBytesInFlight.compare_exchange_weak(held, held + bytes));
+    return true;
+}
+
+// Helper function to cut the input into commands: one per line, with the "\r" of telnet's line ends removed.
+// The line of a binary frame is kept together with its payload, which is only cut once it is complete
+void Connection::cutCommands()
+{
+    size_t start = 0;
+    size_t newline;
+    frameLength = 0;
+    while ((newline = input.find('\n', start)) != std::string::npos)
+    {
+        size_t end = (newline > start && input[newline - 1] == '\r') ? newline - 1 : newline;
+        size_t payload = payloadLength(input, start, end);
+        if (payload > 0)
+        {
+            size_t frameEnd = newline + 1 + payload;
+            if (frameEnd > input.size())
+            {
+                frameLength = frameEnd - start; // Wait for the rest of the payload
+                if (frameLength > MAX_BUFFERED_INPUT && frameReserved == 0)
+                {
+                    if (!reserveFrameBytes(frameLength))
+                    {
+                        frameLength = 0; // runCommands() refuses the frame once the commands before it ran
+                        frameRejected = true;
+                        start = input.size();
+                        break;
+                    }
+                    frameReserved = frameLength;
+                }
+                break;
+            }
+            pending.emplace_back(input, start, frameEnd - start);
+            pendingBytes += frameEnd - start;
+            queuedReserved += frameReserved; // Held until the frame ran (0 unless it is the frame reserved for)
+            frameReserved = 0;
+            start = frameEnd;
+            continue;
+        }
+        pending.emplace_back(input, start, end - start);
+        pendingBytes += end - start;
+        start = newline + 1;
+    }
+    input.erase(0, start);
+}
+
+// Function to queue the complete commands read so far
+bool Connection::queueCommands(bool flushPartial)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    cutCommands();
+    if (flushPartial && !input.empty())
+    {
+        pendingBytes += input.size();
+        pending.push_back(input);
+        input.clear();
+    }
+    inputClosed = inputClosed || flushPartial;
+
+    if ((pending.empty() && !frameRejected) || scheduled || suspended || waiting)
+    {
+        return false; // Nothing to run, or the thread running this connection's commands (or resume()) picks them up
+    }
+    scheduled = true;
+    return true;
+}
+
+// Function to check whether the unterminated input is longer than any command may be
+bool Connection::hasOverlongCommand() const
+{
+    return input.size() > std::max(MAX_COMMAND_LENGTH, frameLength);
+}
+
+// Function to run the queued commands one after the other. The replies go out whenever no other command is
+// waiting, or once HIGH_WATER_MARK bytes of them wait; what the socket does not take suspends the connection,
+// and so does a command that called suspend()
+void Connection::runCommands(const CommandHandler &handler)
+{
+    if (continuation)
+    {
+        finishWaiting(); // resume() ran because the waker was called
+    }
+    while (true)
+    {
+        std::string command;
+        bool next = false;    // Whether to run command now
+        bool refuse = false;  // Whether to refuse the frame that did not fit MAX_FRAME_BYTES_IN_FLIGHT
+        bool stopped = false; // Whether the connection closed
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!closing && !continuation && !pending.empty() && output.pendingBytes() < OutputBuffer::HIGH_WATER_MARK)
+            {
+                command = std::move(pending.front());
+                pending.pop_front();
+                pendingBytes -= command.size();
+                stalled = false; // The client took the earlier replies; this one gets a deadline of its own
+                next = true;
+            }
+            else if (!closing && !continuation && pending.empty() && frameRejected && output.pendingBytes() == 0)
+            {
+                refuse = true;
+            }
+            else if (closing)
+            {
+                pending.clear();
+                pendingBytes = 0;
+                session.publishEdits();
+                continuation = nullptr;
+                scheduled = false;
+                stopped = true;
+            }
+        }
+        if (stopped)
+        {
+            callWakeUp(); // The event loop drops the connection
+            return;
+        }
+        if (refuse)
+        {
+            output << "Server busy: too much upload data in flight. Try again later.\n";
+            output.flush();
+            close(); // The rest of the frame cannot be told apart from commands
+            continue;
+        }
+        if (next)
+        {
+            handler(*this, command);
+            if (output.hasFailed())
+            {
+                close(); // The client is gone
+            }
+            continue;
+        }
+
+        // Send the replies of the commands that were queued together, without waiting for the client
+        session.publishEdits();
+        if (!output.flush())
+        {
+            close();
+            continue;
+        }
+
+        bool wake = false;   // Whether the event loop has to look at the connection again
+        bool finish = false; // Whether the command that waits can finish right away
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (pending.empty())
+            {
+                frameBytesInFlight -= queuedReserved; // The frames cut into commands ran
+                queuedReserved = 0;
+            }
+            if (closing || (!continuation && !pending.empty() && output.pendingBytes() < OutputBuffer::HIGH_WATER_MARK) ||
+                (!continuation && pending.empty() && frameRejected && output.pendingBytes() == 0))
+            {
+                continue; // Closed, more commands arrived meanwhile, or a frame is to be refused
+            }
+            if (continuation && woken)
+            {
+                finish = true; // The waker was called before the command was done
+            }
+            else if (continuation)
+            {
+                waiting = true; // Until the waker is called
+                scheduled = false;
+            }
+            else if (output.pendingBytes() > 0)
+            {
+                suspended = true; // Until the socket is writable
+                scheduled = false;
+                if (!stalled)
+                {
+                    stalled = true;
+                    sendDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SEND_TIMEOUT_MS);
+                }
+                wake = true;
+            }
+            else
+            {
+                scheduled = false; // The next command that arrives needs a new runCommands() call
+                stalled = false;
+                wake = inputClosed; // Everything is answered: the connection can go
+                if (readPaused)
+                {
+                    readPaused = false;
+                    wake = wake || readerParked;
+                }
+            }
+        }
+        if (finish)
+        {
+            finishWaiting();
+            continue;
+        }
+        if (wake)
+        {
+            callWakeUp();
+        }
+        return;
+    }
+}
+
+// Helper function to run the finish of the command that waited
+void Connection::finishWaiting()
+{
+    std::function<void(Connection &)> finish;
+    finish.swap(continuation);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        woken = false;
+        waitTimed = false;
+    }
+    finish(*this);
+    if (output.hasFailed())
+    {
+        close();
+    }
+}
+
+// Function to get the buffer the replies are written to
+OutputBuffer &Connection::out()
+{
+    return output;
+}
+
+// Function to end the connection; the event loop removes it once it sees the socket close
+void Connection::close()
+{
+    if (!closing.exchange(true))
+    {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+}
+
+// Function to check whether close() was called
+bool Connection::isClosing() const
+{
+    return closing;
+}
+
+// Function to make the running command finish later
+std::function<void()> Connection::suspend(std::function<void(Connection &)> finish, long long timeoutMs)
+{
+    continuation = std::move(finish);
+    unsigned long long suspension;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        suspension = ++suspensions;
+        woken = false;
+        waitTimed = timeoutMs >= 0;
+        if (waitTimed)
+        {
+            waitDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        }
+    }
+    std::weak_ptr<Connection> self = shared_from_this();
+    return [self, suspension]()
+    {
+        std::shared_ptr<Connection> connection = self.lock();
+        if (connection)
+        {
+            connection->wake(suspension);
+        }
+    };
+}
+
+// Helper function for the waker of suspend(): lets the command finish, unless it did already
+void Connection::wake(unsigned long long suspension)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (suspension != suspensions || woken)
+        {
+            return; // A waker of an earlier command, e.g. one that timed out
+        }
+        woken = true;
+    }
+    callWakeUp();
+}
+
+// Function to set the event loop's wake-up hook
+void Connection::setWakeUp(std::function<void()> hook)
+{
+    std::lock_guard<std::mutex> lock(wakeUpMutex);
+    wakeUp = std::move(hook);
+}
+
+// Helper function to call the wake-up hook
+void Connection::callWakeUp()
+{
+    std::lock_guard<std::mutex> lock(wakeUpMutex);
+    if (wakeUp)
+    {
+        wakeUp();
+    }
+}
+
+// Function to end a suspension once the socket is writable
+bool Connection::resume()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!(suspended || (waiting && woken)) || scheduled || closing)
+    {
+        return false;
+    }
+    suspended = false;
+    waiting = false;
+    scheduled = true;
+    return true;
+}
+
+// Function to tell the event-handling thread whether to keep watching for input
+bool Connection::parkReader()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (inputClosed || closing)
+    {
+        return false;
+    }
+    readerParked = readPaused;
+    return !readPaused;
+}
+
+// Function to let a parked reader go on once reading has resumed
+bool Connection::unparkReader()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!readerParked || readPaused || closing)
+    {
+        return false;
+    }
+    readerParked = false;
+    return true;
+}
+
+// Function to give up on a client whose replies have waited too long
+void Connection::checkTimers(std::chrono::steady_clock::time_point now)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (suspended && stalled && now >= sendDeadline)
+        {
+            close(); // The client does not read its replies
+        }
+        if (!waiting || !waitTimed || woken || now < waitDeadline)
+        {
+            return;
+        }
+        woken = true; // The command that waits finishes without what it waited for
+    }
+    callWakeUp();
+}
+
+// Function to check whether the connection has nothing left to do
+bool Connection::isDone()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return closing || (inputClosed && !scheduled && !suspended && !waiting && pending.empty() && !frameRejected);
+}
@@ -0,0 +1,204 @@
+#ifndef CONNECTION_HPP
+#define CONNECTION_HPP
+
+#include "GraphRegistry.hpp"
+#include "OutputBuffer.hpp"
+#include "SolveJob.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Binary frames: a command line followed, right after its "\n", by a payload of fixed-size records whose count
+// the line gives. Every field of a record is a 32-bit little-endian integer.
+//   upload <vertices> <edges> [dense]  <edges> records of UPLOAD_RECORD_SIZE bytes: u, v and weight
+//   distances <pairs>                  <pairs> records of PAIR_RECORD_SIZE bytes: u and v
+const size_t UPLOAD_RECORD_SIZE = 12;
+const long long MAX_UPLOAD_EDGES = 16 * 1024 * 1024; // Largest upload accepted (192 MiB of payload)
+const size_t PAIR_RECORD_SIZE = 8;
+const long long MAX_BATCH_PAIRS = 16 * 1024 * 1024;  // Largest distance batch accepted (128 MiB of payload)
+
+// How often the event loops call Connection::checkTimers()
+const int TIMER_INTERVAL_MS = 100;
+
+// Session state of one client: the graph it works on, with the MST solved from it
+struct Session
+{
+    std::shared_ptr<GraphHandle> graph; // The client's private graph, or the named graph it uses
+    std::string graphName;              // Name of that graph, empty for the private one
+    std::map<int, std::shared_ptr<SolveJob>> jobs; // The client's "solve async" jobs by id, oldest first
+    int nextJobId;                                 // Id of the next job
+    std::unique_ptr<GraphHandle::Batch> edits;     // Draft of graph that pipelined "add" / "remove" commands
+                                                   // share, null when none is open (see publishEdits())
+
+    Session() : graph(std::make_shared<GraphHandle>(false)), nextJobId(1) {}
+
+    // Function to publish the edits made since the last call, if any. Called before any other command runs
+    // and before replies go out, so no reply tells of an edit that others cannot see yet
+    void publishEdits()
+    {
+        edits.reset();
+    }
+
+    // Destructor; cancels the jobs, since no one is left to ask for their results
+    ~Session()
+    {
+        for (auto &job : jobs)
+        {
+            job.second->cancel();
+        }
+    }
+};
+
+// One client connection of the server (Reactor or LeaderFollower). The thread handling the socket's events
+// reads whatever arrives on the (non-blocking) socket and cuts it into commands, one per line, except that an
+// binary frame is one command made of its line, "\n" and its payload; the commands of
+// a connection then run one at a time, in order. A client may pipeline any number of commands without waiting for
+// the replies: once MAX_BUFFERED_INPUT bytes are waiting to run, reading pauses and the rest stays in the kernel's
+// socket buffer, so a client streaming faster than its commands run is slowed down by TCP instead of filling
+// the server's memory. A binary frame larger than that is read whole, as long as all connections together hold
+// no more than MAX_FRAME_BYTES_IN_FLIGHT (Connection.cpp) of such frames; one beyond it is refused: the commands
+// before it are answered, then the client gets a "Server busy" reply and is disconnected. Replies never make a thread wait either: when the socket does not take them, the
+// connection is suspended, and its event loop resumes it once the socket is writable (see resume()); so is a
+// command that finishes later, e.g. once a job is done (see suspend()). The
+// socket is closed when the last reference to the connection goes away, so a thread that is still answering
+// never writes to a descriptor reused for another client
+class Connection : public std::enable_shared_from_this<Connection>
+{
+public:
+    // Handles one command of a connection
+    typedef std::function<void(Connection &, const std::string &)> CommandHandler;
+
+    // Outcome of readAvailable()
+    enum ReadResult
+    {
+        OPEN,        // Everything available was read, the connection stays open
+        PEER_CLOSED, // The client closed its side of the connection
+        FAILED       // The socket failed
+    };
+
+    // Constructor taking ownership of a connected, non-blocking socket
+    explicit Connection(int fd);
+
+    // Destructor; closes the socket
+    ~Connection();
+
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+
+    // Function to get the socket
+    int getFd() const;
+
+    // Function to get the client's session (only touched by the thread running its commands)
+    Session &getSession();
+
+    // Function to read everything the socket has (until it would block), or until MAX_BUFFERED_INPUT bytes are
+    // waiting to run; then reading pauses until runCommands() has worked them off. Event-handling thread only
+    ReadResult readAvailable();
+
+    // Function to move every complete line read so far into the command queue; with flushPartial (the client
+    // closed its side), an unterminated last line counts as a command too. Returns true when the caller has to
+    // schedule runCommands() (the connection had no commands running and is not suspended). Event-handling
+    // thread only
+    bool queueCommands(bool flushPartial);
+
+    // Function to check whether the unterminated input is longer than any command may be
+    bool hasOverlongCommand() const;
+
+    // Function to run the queued commands with handler until the queue is empty, the connection closes, or
+    // the socket does not take the replies; the connection is then suspended until resume()
+    void runCommands(const CommandHandler &handler);
+
+    // Function to get the buffer the replies are written to (only used by the thread running the commands).
+    // runCommands() flushes it whenever no other command is waiting, so the replies to pipelined commands go
+    // out together; a failed flush closes the connection
+    OutputBuffer &out();
+
+    // Function for a command that finishes later, e.g. once a job is done; only from the command's handler,
+    // on a connection owned by a shared_ptr. No further command runs until the returned waker is called (from
+    // any thread, safely after the connection is gone) or timeoutMs pass (if it is not negative); finish then
+    // runs on the thread running the commands, to write the command's reply
+    std::function<void()> suspend(std::function<void(Connection &)> finish, long long timeoutMs);
+
+    // Function to set the hook through which the connection asks its event loop to look at it again: once
+    // it is suspended and the socket becomes writable, once a waker was called, once reading may resume (see
+    // parkReader()), and once it is done (see isDone()). Called from any thread without locks of the event
+    // loop; null removes it
+    void setWakeUp(std::function<void()> hook);
+
+    // Function for the event loop, on an event telling that the socket is writable: returns true when the
+    // connection was suspended (or its waker was called), and the caller has to schedule runCommands() to go on
+    bool resume();
+
+    // Function for the event-handling thread once it is done with the socket: returns true when it has to
+    // keep watching it for input. It does not while reading is paused or after the client closed its side; a
+    // paused reader is parked, and the wake-up hook runs when unparkReader() lets it go on
+    bool parkReader();
+
+    // Function for the event loop on a wake-up: returns true (once) when a parked reader may read again
+    bool unparkReader();
+
+    // Function for the event loop's timer (every TIMER_INTERVAL_MS): closes a connection whose client has not
+    // taken a reply (or the replies sent together) within SEND_TIMEOUT_MS of when it first filled the socket,
+    // and wakes up a suspend() whose timeout passed
+    void checkTimers(std::chrono::steady_clock::time_point now);
+
+    // Function to check whether the event loop can drop the connection: it is closing, or the client closed
+    // its side and every command it sent has been answered
+    bool isDone();
+
+    // Function to end the connection: both directions of the socket are shut down, so the event loop sees it
+    // close, and queued commands are dropped. Replies still in out() are lost: flush it first to deliver them.
+    // Safe to call from any thread, more than once
+    void close();
+
+    // Function to check whether close() was called
+    bool isClosing() const;
+
+private:
+    int fd;                          // The client's socket
+    std::string input;               // Bytes read but not yet cut into commands (event-handling thread only)
+    size_t frameLength;              // Length of the binary frame input starts with while its payload is incomplete, else 0 (mtx held)
+    size_t frameReserved;            // Bytes of MAX_FRAME_BYTES_IN_FLIGHT reserved for that frame, protected by mtx
+    size_t queuedReserved;           // Bytes reserved for frames in pending, protected by mtx
+    bool frameRejected;              // Whether a frame did not fit MAX_FRAME_BYTES_IN_FLIGHT, protected by mtx
+    std::deque<std::string> pending; // Commands waiting to run, protected by mtx
+    size_t pendingBytes;             // Total length of the pending commands (line ends not counted), protected by mtx
+    bool scheduled;                  // Whether a thread is running (or about to run) the commands, protected by mtx
+    bool readPaused;                 // Whether readAvailable() stopped at MAX_BUFFERED_INPUT, protected by mtx
+    bool readerParked;               // Whether parkReader() stopped watching for input, protected by mtx
+    bool inputClosed;                // Whether the client closed its side, protected by mtx
+    bool suspended;                  // Whether runCommands() waits for the socket to take the replies, protected by mtx
+    bool stalled;                    // Whether sendDeadline is set: replies have waited since then, protected by mtx
+    std::chrono::steady_clock::time_point sendDeadline; // When a client that does not read is given up on
+    bool waiting;                    // Whether a command waits for its waker (see suspend()), protected by mtx
+    bool woken;                      // Whether the waker of the last suspend() was called, protected by mtx
+    bool waitTimed;                  // Whether waitDeadline is set, protected by mtx
+    std::chrono::steady_clock::time_point waitDeadline; // When a suspend() with a timeout wakes up by itself
+    unsigned long long suspensions;  // Number of suspend() calls, so that a waker knows its own, protected by mtx
+    std::function<void(Connection &)> continuation;     // Finish of the command that waits (command thread only)
+    std::atomic<bool> closing;       // Set by close()
+    std::mutex mtx;                  // Protects the members marked so
+    std::function<void()> wakeUp;    // Hook of the event loop, protected by wakeUpMutex
+    std::mutex wakeUpMutex;          // Held while calling wakeUp, so that setWakeUp(nullptr) waits for the call
+    Session session;                 // The client's graph and MST
+    OutputBuffer output;             // Replies not sent yet
+
+    // Helper function to move the complete commands at the front of input into pending (mtx held)
+    void cutCommands();
+
+    // Helper function to call the wake-up hook, if any
+    void callWakeUp();
+
+    // Helper function for the waker of the given suspend() call (counted by suspensions)
+    void wake(unsigned long long suspension);
+
+    // Helper function to run the finish of the command that waited
+    void finishWaiting();
+};
+
+#endif // CONNECTION_HPP
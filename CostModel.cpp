@@ -0,0 +1,176 @@
+#include "CostModel.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+
+// Weight of a new observation in the running average of a per-unit cost
+const double OBSERVATION_WEIGHT = 0.2;
+
+// Constructor; until calibrate() runs, every unit of work is assumed to cost one nanosecond
+CostModel::CostModel() : numThreads(defaultThreadCount())
+{
+    for (int cost = 0; cost < COST_CLASS_COUNT; ++cost)
+    {
+        msFixed[cost] = 0;
+        msPerUnit[cost] = 1e-6;
+    }
+}
+
+// Helper function to build a connected random graph with n vertices and about m edges
+static Graph calibrationGraph(int n, long long m, Graph::Storage storage, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<int> weight(1, 1000000);
+    Graph graph(n, storage);
+    for (int v = 1; v < n; ++v)
+    {
+        graph.addEdge(v, static_cast<int>(rng() % v), weight(rng)); // Connected, like most real inputs
+    }
+    for (long long i = n - 1; i < m; ++i)
+    {
+        int u = static_cast<int>(rng() % n), v = static_cast<int>(rng() % n);
+        if (u != v)
+        {
+            graph.addEdge(u, v, weight(rng));
+        }
+    }
+    return graph;
+}
+
+// Function to time every algorithm on a tiny graph (fixed cost) and on a larger one (cost per unit of work).
+// Dense-scan Prim gets a dense graph, everything else a sparse one
+void CostModel::calibrate()
+{
+    std::mt19937 rng(2024);
+    Graph tiny = calibrationGraph(16, 32, Graph::SPARSE, rng);
+    Graph tinyDense = calibrationGraph(16, 64, Graph::DENSE, rng);
+    Graph sparse = calibrationGraph(2000, 16000, Graph::SPARSE, rng);
+    Graph dense = calibrationGraph(400, 40000, Graph::DENSE, rng);
+
+    double fixed[COST_CLASS_COUNT], perUnit[COST_CLASS_COUNT];
+    Prim scan(Prim::DENSE_SCAN), heap(Prim::HEAP);
+    Kruskal kruskal;
+    Boruvka boruvka(numThreads);
+    FilterKruskal filterKruskal(numThreads);
+    measure(PRIM_SCAN, scan, tinyDense, dense, fixed[PRIM_SCAN], perUnit[PRIM_SCAN]);
+    measure(PRIM_HEAP, heap, tiny, sparse, fixed[PRIM_HEAP], perUnit[PRIM_HEAP]);
+    measure(KRUSKAL_SORT, kruskal, tiny, sparse, fixed[KRUSKAL_SORT], perUnit[KRUSKAL_SORT]);
+    measure(BORUVKA_ROUNDS, boruvka, tiny, sparse, fixed[BORUVKA_ROUNDS], perUnit[BORUVKA_ROUNDS]);
+    measure(FILTER_KRUSKAL_SORT, filterKruskal, tiny, sparse, fixed[FILTER_KRUSKAL_SORT], perUnit[FILTER_KRUSKAL_SORT]);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (int cost = 0; cost < COST_CLASS_COUNT; ++cost)
+    {
+        msFixed[cost] = fixed[cost];
+        msPerUnit[cost] = perUnit[cost];
+    }
+}
+
+// Helper function to measure the fixed and per-unit cost of one cost class: the tiny graph is almost all
+// fixed cost, and whatever the larger graph takes beyond that is spread over its units of work
+void CostModel::measure(CostClass cost, MSTAlgo &algo, const Graph &tiny, const Graph &large, double &fixed, double &perUnit) const
+{
+    fixed = timeSolve(algo, tiny);
+    double units = work(cost, large.getNumberOfVertices(), large.getNumberOfEdges());
+    perUnit = std::max(timeSolve(algo, large) - fixed, 0.0) / units;
+}
+
+// Function to predict the time (in milliseconds) an algorithm needs on a graph of this size
+double CostModel::predict(MSTFactory::AlgorithmType type, int numVertices, long long numEdges) const
+{
+    CostClass cost = costClass(type, numVertices, numEdges);
+    std::lock_guard<std::mutex> lock(mtx);
+    return msFixed[cost] + msPerUnit[cost] * work(cost, numVertices, numEdges);
+}
+
+// Function to pick the algorithm with the smallest predicted time
+MSTFactory::AlgorithmType CostModel::choose(int numVertices, long long numEdges, double &predictedMs) const
+{
+    MSTFactory::AlgorithmType best = MSTFactory::PRIM;
+    predictedMs = predict(best, numVertices, numEdges);
+    for (int type = 1; type < MSTFactory::ALGORITHM_COUNT; ++type)
+    {
+        MSTFactory::AlgorithmType candidate = static_cast<MSTFactory::AlgorithmType>(type);
+        double predicted = predict(candidate, numVertices, numEdges);
+        if (predicted < predictedMs)
+        {
+            best = candidate;
+            predictedMs = predicted;
+        }
+    }
+    return best;
+}
+
+// Function to feed the measured time of a real solve back into the model (exponential moving average)
+void CostModel::observe(MSTFactory::AlgorithmType type, int numVertices, long long numEdges, double actualMs)
+{
+    CostClass cost = costClass(type, numVertices, numEdges);
+    double units = work(cost, numVertices, numEdges);
+    if (units <= 0 || actualMs <= 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    double measuredPerUnit = std::max(actualMs - msFixed[cost], 0.0) / units;
+    msPerUnit[cost] += OBSERVATION_WEIGHT * (measuredPerUnit - msPerUnit[cost]);
+}
+
+// Helper function to map an algorithm and a graph size to its cost class
+CostModel::CostClass CostModel::costClass(MSTFactory::AlgorithmType type, int numVertices, long long numEdges)
+{
+    switch (type)
+    {
+    case MSTFactory::PRIM:
+        return Prim::prefersDenseScan(numVertices, numEdges) ? PRIM_SCAN : PRIM_HEAP;
+    case MSTFactory::KRUSKAL:
+        return KRUSKAL_SORT;
+    case MSTFactory::BORUVKA:
+        return BORUVKA_ROUNDS;
+    case MSTFactory::FILTER_KRUSKAL:
+        return FILTER_KRUSKAL_SORT;
+    }
+    return KRUSKAL_SORT;
+}
+
+// Helper function to get the amount of work of a cost class on a graph of this size. Every formula includes
+// the O(V + E) of collecting the edges and building the MSTTree
+double CostModel::work(CostClass cost, int numVertices, long long numEdges) const
+{
+    double n = numVertices;
+    double m = static_cast<double>(numEdges);
+    double logN = std::log2(n + 2);
+    switch (cost)
+    {
+    case PRIM_SCAN:
+        return n * n + m;
+    case PRIM_HEAP:
+        return (n + m) * logN;
+    case KRUSKAL_SORT:
+        // V + 2E, not E log V: V + E to collect the edges and build the tree, plus E for the radix sort, whose
+        // passes are linear in E (their number depends on the weight range and is folded into msPerUnit)
+        return n + m * 2;
+    case BORUVKA_ROUNDS:
+        return n + m + (n + m) * logN / numThreads;
+    case FILTER_KRUSKAL_SORT:
+        return n + m + n * logN * std::log2(m / (n + 1) + 2) / numThreads;
+    default:
+        return n + m;
+    }
+}
+
+// Helper function to time one solve of graph, in milliseconds (best of three, to skip warm-up effects)
+double CostModel::timeSolve(MSTAlgo &algo, const Graph &graph)
+{
+    double best = 0;
+    for (int run = 0; run < 3; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        algo.computeMST(graph);
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        best = (run == 0 || elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
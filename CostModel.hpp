@@ -0,0 +1,58 @@
+#ifndef COSTMODEL_HPP
+#define COSTMODEL_HPP
+
+#include "MST_algo.hpp"
+#include <mutex>
+
+// Predicts how long each MST algorithm takes on a graph from its vertex and edge counts, so that
+// "solve auto" can dispatch to the fastest one. Every algorithm has a work formula (e.g. (V + E) log V for
+// heap Prim, V + 2E for Kruskal with its radix sort), a fixed cost per solve and a cost per unit of work;
+// calibrate() measures both on this machine and observe() keeps refining the per-unit costs with the times of
+// real solves. All functions are thread safe
+class CostModel
+{
+public:
+    // Constructor; until calibrate() runs, every unit of work is assumed to cost one nanosecond
+    CostModel();
+
+    // Function to time every algorithm on small random graphs and derive its costs (takes ~100 ms optimized)
+    void calibrate();
+
+    // Function to predict the time (in milliseconds) an algorithm needs on a graph of this size
+    double predict(MSTFactory::AlgorithmType type, int numVertices, long long numEdges) const;
+
+    // Function to pick the algorithm with the smallest predicted time; predictedMs receives that time
+    MSTFactory::AlgorithmType choose(int numVertices, long long numEdges, double &predictedMs) const;
+
+    // Function to feed the measured time of a real solve back into the model
+    void observe(MSTFactory::AlgorithmType type, int numVertices, long long numEdges, double actualMs);
+
+private:
+    // Cost units of work; Prim has two because its mode depends on the density
+    enum CostClass
+    {
+        PRIM_SCAN,
+        PRIM_HEAP,
+        KRUSKAL_SORT,
+        BORUVKA_ROUNDS,
+        FILTER_KRUSKAL_SORT,
+        COST_CLASS_COUNT
+    };
+
+    mutable std::mutex mtx;                    // Protects msFixed and msPerUnit
+    double msFixed[COST_CLASS_COUNT];          // Measured cost of one solve of a tiny graph, in milliseconds
+    double msPerUnit[COST_CLASS_COUNT];        // Measured cost of one unit of work, in milliseconds
+    int numThreads;                            // Threads the parallel algorithms run with
+
+    // Helper functions to map an algorithm and a graph size to its cost class and amount of work
+    static CostClass costClass(MSTFactory::AlgorithmType type, int numVertices, long long numEdges);
+    double work(CostClass cost, int numVertices, long long numEdges) const;
+
+    // Helper function to time one solve of graph, in milliseconds
+    static double timeSolve(MSTAlgo &algo, const Graph &graph);
+
+    // Helper function to measure the fixed and per-unit cost of one cost class from a tiny and a larger graph
+    void measure(CostClass cost, MSTAlgo &algo, const Graph &tiny, const Graph &large, double &fixed, double &perUnit) const;
+};
+
+#endif // COSTMODEL_HPP
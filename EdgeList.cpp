@@ -0,0 +1,126 @@
+#include "EdgeList.hpp"
+#include <algorithm>
+
+// Function to reserve room for count edges
+void EdgeList::reserve(size_t count)
+{
+    weights.reserve(count);
+    from.reserve(count);
+    to.reserve(count);
+}
+
+// Function to remove all edges (the capacity is kept)
+void EdgeList::clear()
+{
+    weights.clear();
+    from.clear();
+    to.clear();
+}
+
+// Function to sort the edges by weight, choosing the faster sort for the list size
+void sortByWeight(EdgeList &edges)
+{
+    EdgeList scratch;
+    sortByWeight(edges, scratch);
+}
+
+// Function to sort the edges by weight with the radix sort's buffers taken from scratch
+void sortByWeight(EdgeList &edges, EdgeList &scratch, const std::atomic<bool> *cancelFlag)
+{
+    if (edges.size() < RADIX_SORT_THRESHOLD)
+    {
+        insertionSortByWeight(edges); // Needs no buffer at all
+    }
+    else
+    {
+        radixSortByWeight(edges, scratch, cancelFlag);
+    }
+}
+
+// Function to sort the edges by weight with an LSD radix sort over 8-bit digits
+void radixSortByWeight(EdgeList &edges)
+{
+    EdgeList scratch;
+    radixSortByWeight(edges, scratch);
+}
+
+// Function to sort the edges by weight with an LSD radix sort, scattering into scratch. Every pass swaps the
+// arrays of edges and scratch, so both stay allocated for reuse. The cancel flag is checked before each of
+// the two sweeps of a pass, which bounds the delay of a cancellation by one O(E) sweep
+void radixSortByWeight(EdgeList &edges, EdgeList &scratch, const std::atomic<bool> *cancelFlag)
+{
+    auto cancelled = [cancelFlag]()
+    { return cancelFlag && cancelFlag->load(std::memory_order_relaxed); };
+    size_t count = edges.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    // Sort on weight - minWeight, so negative weights work and leading zero bytes can be skipped
+    auto range = std::minmax_element(edges.weights.begin(), edges.weights.end());
+    unsigned int minWeight = static_cast<unsigned int>(*range.first);
+    unsigned int span = static_cast<unsigned int>(*range.second) - minWeight;
+
+    std::vector<int> &weights = scratch.weights, &from = scratch.from, &to = scratch.to;
+    weights.resize(count);
+    from.resize(count);
+    to.resize(count);
+    for (int shift = 0; shift < 32 && (span >> shift) != 0; shift += 8)
+    {
+        if (cancelled())
+        {
+            return;
+        }
+
+        // Counting pass: histogram of this byte, turned into the start offset of each bucket
+        size_t offset[256] = {0};
+        for (size_t i = 0; i < count; ++i)
+        {
+            offset[((static_cast<unsigned int>(edges.weights[i]) - minWeight) >> shift) & 0xFF]++;
+        }
+        size_t total = 0;
+        for (size_t &bucket : offset)
+        {
+            size_t size = bucket;
+            bucket = total;
+            total += size;
+        }
+
+        if (cancelled())
+        {
+            return;
+        }
+
+        // Scatter pass: stable, so the order of the lower bytes survives
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t target = offset[((static_cast<unsigned int>(edges.weights[i]) - minWeight) >> shift) & 0xFF]++;
+            weights[target] = edges.weights[i];
+            from[target] = edges.from[i];
+            to[target] = edges.to[i];
+        }
+        edges.weights.swap(weights);
+        edges.from.swap(from);
+        edges.to.swap(to);
+    }
+}
+
+// Function to sort the edges by weight with an insertion sort: every edge moves left past the heavier ones
+void insertionSortByWeight(EdgeList &edges)
+{
+    for (size_t i = 1; i < edges.size(); ++i)
+    {
+        int weight = edges.weights[i], from = edges.from[i], to = edges.to[i];
+        size_t j = i;
+        for (; j > 0 && edges.weights[j - 1] > weight; --j)
+        {
+            edges.weights[j] = edges.weights[j - 1];
+            edges.from[j] = edges.from[j - 1];
+            edges.to[j] = edges.to[j - 1];
+        }
+        edges.weights[j] = weight;
+        edges.from[j] = from;
+        edges.to[j] = to;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef EDGELIST_HPP
+#define EDGELIST_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Below this many edges the comparison sort beats the radix sort (measured with `make bench`)
+const size_t RADIX_SORT_THRESHOLD = 64;
+
+// Structure-of-arrays edge buffer: edge i is (from[i], to[i]) with weight weights[i].
+// Keeping the weights in their own array lets the sort stream over the keys without touching the endpoints
+struct EdgeList
+{
+    std::vector<int> weights; // Weight of each edge
+    std::vector<int> from;    // First endpoint of each edge
+    std::vector<int> to;      // Second endpoint of each edge
+
+    // Function to get the number of edges
+    size_t size() const { return weights.size(); }
+
+    // Function to reserve room for count edges
+    void reserve(size_t count);
+
+    // Function to append the edge (u, v) with weight w
+    void push(int u, int v, int weight)
+    {
+        weights.push_back(weight);
+        from.push_back(u);
+        to.push_back(v);
+    }
+
+    // Function to remove all edges (the capacity is kept)
+    void clear();
+};
+
+// Function to sort the edges by weight (stable), choosing the faster sort for the list size
+void sortByWeight(EdgeList &edges);
+
+// Same, with the buffers of the radix sort taken from scratch: when scratch (and edges) already have room for
+// every edge, the sort does not allocate. Afterwards scratch holds leftover data of the same capacity.
+// Once *cancelFlag is set (if given), the radix sort stops at its next pass, leaving the edges unsorted: for
+// an MST computation that is being cancelled (see MSTAlgo::setCancelFlag())
+void sortByWeight(EdgeList &edges, EdgeList &scratch, const std::atomic<bool> *cancelFlag = nullptr);
+
+// Function to sort the edges by weight with an LSD radix sort. Only the bytes in which the weights
+// actually differ get a pass, so small weight ranges need fewer passes
+void radixSortByWeight(EdgeList &edges);
+void radixSortByWeight(EdgeList &edges, EdgeList &scratch, const std::atomic<bool> *cancelFlag = nullptr);
+
+// Function to sort the edges by weight with an in-place insertion sort (stable; for short lists only)
+void insertionSortByWeight(EdgeList &edges);
+
+#endif // EDGELIST_HPP
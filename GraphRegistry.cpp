@@ -0,0 +1,79 @@
+#include "GraphRegistry.hpp"
+
+GraphHandle::GraphHandle(bool shared) : shared(shared), version(std::make_shared<GraphVersion>())
+{
+}
+
+// Function to get the current version
+std::shared_ptr<const GraphVersion> GraphHandle::current() const
+{
+    return std::atomic_load(&version);
+}
+
+// Constructor of a batch: a shared graph may be read by any thread at any time, and a private one by whoever
+// still holds its current version, so their drafts are copies of the version (sharing its graph and MST)
+GraphHandle::Batch::Batch(GraphHandle &handle) : handle(handle), lock(handle.writeMutex), version(std::atomic_load(&handle.version))
+{
+    if (handle.shared || version.use_count() > 2) // Held by a reader besides this draft and the handle
+    {
+        version = std::make_shared<GraphVersion>(*version); // Shares the graph and the MST until they are edited
+    }
+}
+
+// Destructor; publishes the draft, before the lock is released
+GraphHandle::Batch::~Batch()
+{
+    std::atomic_store(&handle.version, version);
+}
+
+// Function to get the draft
+GraphVersion &GraphHandle::Batch::draft()
+{
+    return *version;
+}
+
+// Function to make the graph of a draft its own: a graph that another version still points to is copied
+Graph &GraphHandle::writableGraph(GraphVersion &draft)
+{
+    if (draft.graph.use_count() > 1)
+    {
+        draft.graph = std::make_shared<Graph>(*draft.graph);
+    }
+    return *draft.graph;
+}
+
+// Function to make the MST of a draft its own, the same way
+MSTTree &GraphHandle::writableMst(GraphVersion &draft)
+{
+    if (draft.mst.use_count() > 1)
+    {
+        draft.mst = std::make_shared<MSTTree>(*draft.mst);
+    }
+    return *draft.mst;
+}
+
+// Function to check whether the graph is shared between connections
+bool GraphHandle::isShared() const
+{
+    return shared;
+}
+
+// Function to get the graph called name, registering an empty one if there is none
+std::shared_ptr<GraphHandle> GraphRegistry::open(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    std::shared_ptr<GraphHandle> &handle = graphs[name];
+    if (!handle)
+    {
+        handle = std::make_shared<GraphHandle>(true);
+    }
+    return handle;
+}
+
+// Function to get the graph called name, or null if there is none
+std::shared_ptr<GraphHandle> GraphRegistry::find(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = graphs.find(name);
+    return it == graphs.end() ? nullptr : it->second;
+}
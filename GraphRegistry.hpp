@@ -0,0 +1,104 @@
+#ifndef GRAPHREGISTRY_HPP
+#define GRAPHREGISTRY_HPP
+
+#include "graph.hpp"
+#include "MST_tree.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// One version of a graph and of the MST solved from it. A published version is a consistent snapshot: it is
+// never changed while anyone besides its writer can see it (see GraphHandle::update)
+struct GraphVersion
+{
+    std::shared_ptr<Graph> graph; // The graph, null until "create" or "upload"
+    std::shared_ptr<MSTTree> mst; // The MST of exactly this graph, null until "solve"
+};
+
+// A graph that changes by publishing new versions (copy-on-write). Readers take the current version with
+// current() and keep using it for as long as they hold it, whatever is published meanwhile: they never wait
+// for a writer and never see half of a change. Writers of one graph take turns.
+//
+// A private graph belongs to one connection, which is the only one to read it; as long as no one else holds
+// its version (an earlier snapshot), a change is made in place instead of on a copy. A shared graph (one of
+// GraphRegistry's) may be read by any thread at any time, so its changes always go to copies. A copy costs
+// O(V + E) for the graph and as much again for a solved MST, whatever the change: a run of changes should go
+// through one Batch, which copies once
+class GraphHandle
+{
+public:
+    // Constructor of an empty graph (no version published yet), private to one connection or shared
+    explicit GraphHandle(bool shared);
+
+    GraphHandle(const GraphHandle &) = delete;
+    GraphHandle &operator=(const GraphHandle &) = delete;
+
+    // Function to get the current version; never null, its graph is null while there is none
+    std::shared_ptr<const GraphVersion> current() const;
+
+    // A run of changes by one writer, published together as one version when the batch is destroyed. The draft
+    // is made once (a copy of the current version if readers may hold it) and every change of the batch edits
+    // it in place, so a run of edits to a shared graph copies the graph and the MST once instead of once per
+    // edit. Other writers of the graph wait until the batch is published
+    class Batch
+    {
+    public:
+        // Constructor; waits for the other writers and makes the draft
+        explicit Batch(GraphHandle &handle);
+
+        // Destructor; publishes the draft as the current version
+        ~Batch();
+
+        Batch(const Batch &) = delete;
+        Batch &operator=(const Batch &) = delete;
+
+        // Function to get the draft; change it like update() does
+        GraphVersion &draft();
+
+    private:
+        GraphHandle &handle;                   // The graph being changed
+        std::unique_lock<std::mutex> lock;     // The handle's writeMutex, held until the draft is published
+        std::shared_ptr<GraphVersion> version; // The draft
+    };
+
+    // Function to change the graph: change(draft) gets a draft of the current version, whose graph and MST it
+    // may replace, or edit after making them its own with writableGraph() / writableMst(). The draft is then
+    // published as the current version. The same as a Batch of one change
+    template <typename Change>
+    void update(Change change)
+    {
+        Batch batch(*this);
+        change(batch.draft());
+    }
+
+    // Functions to make the graph or the MST of a draft its own (copying it if another version uses it too)
+    // before it is edited in place
+    static Graph &writableGraph(GraphVersion &draft);
+    static MSTTree &writableMst(GraphVersion &draft);
+
+    // Function to check whether the graph is shared between connections
+    bool isShared() const;
+
+private:
+    bool shared;                           // Whether other connections may read the graph
+    std::mutex writeMutex;                 // Held by a Batch (and so by update()), so writers take turns
+    std::shared_ptr<GraphVersion> version; // The current version, only accessed with std::atomic_load/store
+};
+
+// The named graphs of the server, shared by every client ("create <name> ...", "use <name>")
+class GraphRegistry
+{
+public:
+    // Function to get the graph called name, registering an empty one if there is none
+    std::shared_ptr<GraphHandle> open(const std::string &name);
+
+    // Function to get the graph called name, or null if there is none
+    std::shared_ptr<GraphHandle> find(const std::string &name) const;
+
+private:
+    mutable std::mutex mtx;                                               // Guards graphs
+    std::unordered_map<std::string, std::shared_ptr<GraphHandle>> graphs; // The graphs by name
+};
+
+#endif // GRAPHREGISTRY_HPP
@@ -0,0 +1,130 @@
+#include "IndexedHeap.hpp"
+
+// Function to empty the heap and allow ids up to capacity - 1
+void IndexedHeap::reset(int capacity)
+{
+    heap.clear();
+    if (static_cast<int>(keys.size()) < capacity)
+    {
+        keys.resize(capacity);
+    }
+    heap.reserve(capacity);        // So pushes never reallocate during a run
+    position.assign(capacity, -1); // Reuses the existing buffer when it is large enough
+}
+
+// Function to check whether the heap is empty
+bool IndexedHeap::empty() const
+{
+    return heap.empty();
+}
+
+// Function to get the number of ids in the heap
+int IndexedHeap::size() const
+{
+    return static_cast<int>(heap.size());
+}
+
+// Function to check whether id is in the heap
+bool IndexedHeap::contains(int id) const
+{
+    return position[id] != -1;
+}
+
+// Function to insert id, or lower its key if it is already in the heap
+bool IndexedHeap::pushOrDecrease(int id, int key)
+{
+    if (position[id] == -1)
+    {
+        position[id] = static_cast<int>(heap.size());
+        heap.push_back(id);
+    }
+    else if (key >= keys[id])
+    {
+        return false;
+    }
+
+    keys[id] = key;
+    siftUp(position[id]); // A smaller key can only move towards the root
+    return true;
+}
+
+// Function to get the smallest key in the heap
+int IndexedHeap::topKey() const
+{
+    return keys[heap[0]];
+}
+
+// Function to remove the id with the smallest key and return it
+int IndexedHeap::pop()
+{
+    int top = heap[0];
+    int last = heap.back();
+    heap.pop_back();
+    position[top] = -1;
+
+    if (!heap.empty())
+    {
+        heap[0] = last;
+        position[last] = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+// Helper function to move the entry at index i up until its parent's key is not larger.
+// The entry is held aside and written once at its final index instead of being swapped at every level
+void IndexedHeap::siftUp(int i)
+{
+    int id = heap[i];
+    int key = keys[id];
+    while (i > 0)
+    {
+        int parent = (i - 1) / ARITY;
+        if (keys[heap[parent]] <= key)
+        {
+            break;
+        }
+        heap[i] = heap[parent];
+        position[heap[i]] = i;
+        i = parent;
+    }
+    heap[i] = id;
+    position[id] = i;
+}
+
+// Helper function to move the entry at index i down until none of its children has a smaller key
+void IndexedHeap::siftDown(int i)
+{
+    int count = static_cast<int>(heap.size());
+    int id = heap[i];
+    int key = keys[id];
+    while (true)
+    {
+        int first = ARITY * i + 1;
+        if (first >= count)
+        {
+            break;
+        }
+
+        // Smallest of the (up to) ARITY children
+        int smallest = first;
+        int last = (first + ARITY < count) ? first + ARITY : count;
+        for (int child = first + 1; child < last; ++child)
+        {
+            if (keys[heap[child]] < keys[heap[smallest]])
+            {
+                smallest = child;
+            }
+        }
+
+        if (keys[heap[smallest]] >= key)
+        {
+            break;
+        }
+        heap[i] = heap[smallest];
+        position[heap[i]] = i;
+        i = smallest;
+    }
+    heap[i] = id;
+    position[id] = i;
+}
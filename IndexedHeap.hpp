@@ -0,0 +1,47 @@
+#ifndef INDEXEDHEAP_HPP
+#define INDEXEDHEAP_HPP
+
+#include <vector>
+
+// Indexed 4-ary min-heap over the ids 0 .. capacity - 1. Every id is in the heap at most once, and its key can
+// be lowered in place (decrease-key), so the heap never holds more than capacity entries.
+// A 4-ary heap is half as deep as a binary one and the four children of a node share a cache line
+class IndexedHeap
+{
+public:
+    static const int ARITY = 4; // Children per node
+
+    // Function to empty the heap and allow ids up to capacity - 1. Storage is kept between runs and only
+    // grows, so reusing one heap for many solves does not allocate once it has seen the largest graph
+    void reset(int capacity);
+
+    // Function to check whether the heap is empty
+    bool empty() const;
+
+    // Function to get the number of ids in the heap
+    int size() const;
+
+    // Function to check whether id is in the heap
+    bool contains(int id) const;
+
+    // Function to insert id with the given key, or lower its key if it is already in the heap.
+    // Returns false (and changes nothing) if id is in the heap with a key that is not larger
+    bool pushOrDecrease(int id, int key);
+
+    // Function to get the smallest key in the heap (the heap must not be empty)
+    int topKey() const;
+
+    // Function to remove the id with the smallest key and return it (the heap must not be empty)
+    int pop();
+
+private:
+    std::vector<int> heap;     // Ids in heap order
+    std::vector<int> keys;     // Key of every id in the heap
+    std::vector<int> position; // Index of every id in heap, -1 when it is not in the heap
+
+    // Helper functions to restore the heap order after a key moved up or down at index i
+    void siftUp(int i);
+    void siftDown(int i);
+};
+
+#endif // INDEXEDHEAP_HPP
@@ -0,0 +1,314 @@
+#include "LeaderFollower.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Events a client socket is (re-)armed for; after one of them fires, the socket stays silent until re-armed
+const uint32_t CLIENT_EVENTS = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+
+// Events the wake-up hook arms a client's notifyFd for: a woken-up connection is resumed once it can write
+const uint32_t NOTIFY_EVENTS = EPOLLOUT | EPOLLONESHOT;
+
+// Marks the events of a notifyFd in epoll_event::data.u64, whose low 32 bits hold the client's socket
+const uint64_t NOTIFY_TAG = 1ULL << 32;
+
+// Constructor to register the listening socket and the wake-up eventfd with a new epoll instance
+LeaderFollower::LeaderFollower(int listenFd, int numThreads, Connection::CommandHandler handler)
+    : listenFd(listenFd), epollFd(-1), wakeFd(-1), numThreads(numThreads), handler(std::move(handler)), running(true),
+      nextTimerCheck(std::chrono::steady_clock::now())
+{
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0)
+    {
+        perror("epoll"); // Print error if the handle set cannot be set up
+        exit(EXIT_FAILURE);
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLONESHOT; // Only the thread that took it accepts
+    event.data.u64 = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.events = EPOLLIN; // Never read, so once written every epoll_wait() returns it
+    event.data.u64 = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+}
+
+LeaderFollower::~LeaderFollower()
+{
+    ::close(wakeFd);
+    ::close(epollFd);
+}
+
+// Function to run the pool: numThreads - 1 new threads plus the calling one
+void LeaderFollower::run()
+{
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back(&LeaderFollower::leadAndFollow, this);
+    }
+    leadAndFollow();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    // Disconnect every client
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (auto &entry : connections)
+    {
+        entry.second.connection->close();
+        entry.second.connection->setWakeUp(nullptr); // Jobs may still try to wake it up
+        ::close(entry.second.notifyFd);
+        std::cout << "Closed client socket: " << entry.first << std::endl;
+    }
+    connections.clear();
+}
+
+// Function to make run() return
+void LeaderFollower::stop()
+{
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0)
+    {
+        perror("eventfd write");
+    }
+}
+
+// Helper function run by every thread: wait to become the leader, wait for one event, hand the leadership on,
+// then handle the event
+void LeaderFollower::leadAndFollow()
+{
+    while (running)
+    {
+        epoll_event event;
+        int ready;
+        {
+            std::lock_guard<std::mutex> leader(leaderMutex); // Followers queue up here
+            if (!running)
+            {
+                return;
+            }
+            checkTimers();
+            ready = epoll_wait(epollFd, &event, 1, TIMER_INTERVAL_MS);
+        } // Leaving the scope promotes the next follower before this thread handles the event
+
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("epoll_wait");
+            return;
+        }
+        int fd = static_cast<int>(event.data.u64 & 0xffffffff);
+        if (ready == 0 || fd == wakeFd)
+        {
+            continue; // Time to check the timers, or stop() was called and running is already false
+        }
+
+        if (event.data.u64 & NOTIFY_TAG)
+        {
+            handleWakeUp(fd);
+        }
+        else if (fd == listenFd)
+        {
+            acceptClients();
+        }
+        else
+        {
+            handleClient(fd, event.events);
+        }
+    }
+}
+
+// Helper function to accept clients until none is pending, then re-arm the listening socket
+void LeaderFollower::acceptClients()
+{
+    while (true)
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                perror("accept"); // E.g. out of descriptors: the remaining clients are accepted later
+            }
+            break;
+        }
+
+        int notifyFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (notifyFd < 0)
+        {
+            perror("dup"); // Out of descriptors: turn the client away
+            ::close(fd);
+            continue;
+        }
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+        int epoll = epollFd;
+        connection->setWakeUp([epoll, fd, notifyFd]()
+                              {
+            epoll_event notify = {};
+            notify.events = NOTIFY_EVENTS;
+            notify.data.u64 = NOTIFY_TAG | static_cast<uint32_t>(fd);
+            epoll_ctl(epoll, EPOLL_CTL_MOD, notifyFd, &notify); });
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            connections[fd] = Client{connection, notifyFd};
+        }
+        epoll_event event = {};
+        event.events = EPOLLONESHOT; // Disarmed until the wake-up hook arms it
+        event.data.u64 = NOTIFY_TAG | static_cast<uint32_t>(fd);
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, notifyFd, &event);
+        event.events = CLIENT_EVENTS;
+        event.data.u64 = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        std::cout << "New client connection accepted.\n"; // Print message about new client
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, listenFd, &event);
+}
+
+// Helper function to handle a client's event. Its socket is disarmed meanwhile, so this thread has the client's
+// input to itself. A client that closed its side still gets the replies to the commands it sent before
+void LeaderFollower::handleClient(int fd, uint32_t events)
+{
+    std::shared_ptr<Connection> connection = findConnection(fd);
+    if (!connection)
+    {
+        return;
+    }
+
+    Connection::ReadResult result = connection->readAvailable();
+    if (result != Connection::FAILED && connection->queueCommands(result == Connection::PEER_CLOSED))
+    {
+        connection->runCommands(handler); // Right here: no queue, no other thread
+    }
+
+    if (connection->hasOverlongCommand())
+    {
+        std::cout << "Client sent an overlong command.\n";
+        connection->close();
+    }
+    if (result == Connection::FAILED || (events & EPOLLERR))
+    {
+        connection->close();
+    }
+
+    if (connection->isDone())
+    {
+        removeConnection(fd);
+    }
+    else if (connection->parkReader())
+    {
+        watchInput(fd);
+    }
+}
+
+// Helper function to handle a client's wake-up: resume its commands if they wait for the socket, and re-arm its
+// input if reading may go on. Several wake-ups of a client may be handled at once, the connection sorts them out
+void LeaderFollower::handleWakeUp(int fd)
+{
+    std::shared_ptr<Connection> connection = findConnection(fd);
+    if (!connection)
+    {
+        return;
+    }
+
+    if (connection->resume())
+    {
+        connection->runCommands(handler);
+    }
+
+    if (connection->isDone())
+    {
+        removeConnection(fd);
+    }
+    else if (connection->unparkReader())
+    {
+        watchInput(fd);
+    }
+}
+
+// Helper function to look up a client
+std::shared_ptr<Connection> LeaderFollower::findConnection(int fd)
+{
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    auto it = connections.find(fd);
+    return it == connections.end() ? nullptr : it->second.connection;
+}
+
+// Helper function to re-arm a client's input
+void LeaderFollower::watchInput(int fd)
+{
+    epoll_event event = {};
+    event.events = CLIENT_EVENTS; // Level-triggered, so input that arrived meanwhile fires right away
+    event.data.u64 = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event); // Fails harmlessly if the client was removed meanwhile
+}
+
+// Helper function to check the timers of every client, at most every TIMER_INTERVAL_MS (leaderMutex held)
+void LeaderFollower::checkTimers()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now < nextTimerCheck)
+    {
+        return;
+    }
+    nextTimerCheck = now + std::chrono::milliseconds(TIMER_INTERVAL_MS);
+
+    std::vector<std::pair<int, std::shared_ptr<Connection>>> clients;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        clients.reserve(connections.size());
+        for (auto &entry : connections)
+        {
+            clients.emplace_back(entry.first, entry.second.connection);
+        }
+    }
+    for (auto &client : clients)
+    {
+        client.second->checkTimers(now);
+        if (client.second->isDone())
+        {
+            removeConnection(client.first); // E.g. closed by its timer while no event of it is armed
+        }
+    }
+}
+
+// Helper function to stop watching a client
+void LeaderFollower::removeConnection(int fd)
+{
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    auto it = connections.find(fd);
+    if (it == connections.end())
+    {
+        return; // Another thread removed it first
+    }
+    it->second.connection->setWakeUp(nullptr); // notifyFd is closed below, so it must not be armed any more
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.notifyFd, nullptr);
+    ::close(it->second.notifyFd);
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    connections.erase(it); // The socket closes with the last reference
+    std::cout << "Client disconnected.\n";
+}
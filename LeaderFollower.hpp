@@ -0,0 +1,84 @@
+#ifndef LEADERFOLLOWER_HPP
+#define LEADERFOLLOWER_HPP
+
+#include "Connection.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Leader-Follower server: a pool of threads shares one epoll handle set. One thread at a time, the leader,
+// waits on it; the others (followers) wait for their turn. When an event arrives the leader promotes a
+// follower and then handles the event itself (accepting, or reading a client's commands and running them), so
+// no event is ever handed to another thread through a queue. Client sockets are registered with EPOLLONESHOT:
+// once an event of a client is taken no other thread can get one until it is re-armed, so the commands of a
+// client still run one at a time and in order. Each client has a second descriptor of its socket (dup()),
+// registered on its own for EPOLLOUT: the connection's wake-up hook arms it from any thread, without touching
+// the input side that another thread may be handling
+class LeaderFollower
+{
+public:
+    // Constructor; listenFd must be a bound, listening socket (it is made non-blocking). Commands are run
+    // by handler on the thread that took their event
+    LeaderFollower(int listenFd, int numThreads, Connection::CommandHandler handler);
+
+    // Destructor; closes the epoll instance (not the listening socket)
+    ~LeaderFollower();
+
+    LeaderFollower(const LeaderFollower &) = delete;
+    LeaderFollower &operator=(const LeaderFollower &) = delete;
+
+    // Function to run the thread pool (the calling thread included) until stop() is called; then every client
+    // is disconnected
+    void run();
+
+    // Function to make run() return once the running commands are done. Safe to call from any thread
+    void stop();
+
+private:
+    int listenFd;                       // The listening socket
+    int epollFd;                        // The shared handle set
+    int wakeFd;                         // eventfd that stop() writes to; level-triggered, so it wakes every thread
+    int numThreads;                     // Threads taking turns as leader
+    Connection::CommandHandler handler; // Handles one command
+    std::atomic<bool> running;          // Cleared by stop()
+    std::mutex leaderMutex;             // Held by the leader, followers wait for it
+    std::chrono::steady_clock::time_point nextTimerCheck; // When the leader next checks the timers, protected by leaderMutex
+
+    // An open client
+    struct Client
+    {
+        std::shared_ptr<Connection> connection;
+        int notifyFd; // The socket's second descriptor, armed for EPOLLOUT by the wake-up hook
+    };
+    std::mutex connectionsMutex;                  // Protects connections
+    std::unordered_map<int, Client> connections; // Open clients by socket
+
+    // Helper function run by every thread of the pool: lead, promote, handle, follow again
+    void leadAndFollow();
+
+    // Helper function to accept every pending client, then re-arm the listening socket
+    void acceptClients();
+
+    // Helper function to read a client's commands and run them on this thread, then re-arm or drop the client
+    void handleClient(int fd, uint32_t events);
+
+    // Helper function to handle a client's wake-up: go on with its commands, re-arm its input, or drop it
+    void handleWakeUp(int fd);
+
+    // Helper function to look up a client; null if it is gone
+    std::shared_ptr<Connection> findConnection(int fd);
+
+    // Helper function to arm a client's socket for input again
+    void watchInput(int fd);
+
+    // Helper function run by the leader: every TIMER_INTERVAL_MS, check the timers of every client
+    void checkTimers();
+
+    // Helper function to stop watching a client. It stays alive until the last reference goes away
+    void removeConnection(int fd);
+};
+
+#endif // LEADERFOLLOWER_HPP
@@ -0,0 +1,212 @@
+#include "LinkCutTree.hpp"
+#include <utility>
+
+// Constructor to create count isolated nodes with the given weight
+LinkCutTree::LinkCutTree(int count, int weight)
+{
+    nodes.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        addNode(weight);
+    }
+}
+
+// Function to add an isolated node and return its id
+int LinkCutTree::addNode(int weight)
+{
+    int x;
+    if (!freeNodes.empty())
+    {
+        x = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else
+    {
+        x = static_cast<int>(nodes.size());
+        nodes.push_back(Node());
+    }
+    nodes[x] = {{-1, -1}, -1, false, weight, x};
+    return x;
+}
+
+// Function to remove an isolated node
+void LinkCutTree::removeNode(int x)
+{
+    freeNodes.push_back(x);
+}
+
+// Function to change the weight of node x
+void LinkCutTree::setWeight(int x, int weight)
+{
+    access(x);
+    splay(x); // x is now the root of its splay tree, so only its own aggregate changes
+    nodes[x].weight = weight;
+    update(x);
+}
+
+// Function to get the weight of node x
+int LinkCutTree::getWeight(int x) const
+{
+    return nodes[x].weight;
+}
+
+// Function to connect the trees of x and y
+void LinkCutTree::link(int x, int y)
+{
+    makeRoot(x);
+    nodes[x].parent = y; // Path-parent pointer: x's whole tree hangs below y
+}
+
+// Function to remove the link x - y
+void LinkCutTree::cut(int x, int y)
+{
+    makeRoot(x);
+    access(y);
+    splay(y);
+    // The path is exactly x - y, so x is y's left child in the splay tree
+    nodes[y].child[0] = -1;
+    nodes[x].parent = -1;
+    update(y);
+}
+
+// Function to check whether x and y are in the same tree
+bool LinkCutTree::connected(int x, int y)
+{
+    return x == y || findRoot(x) == findRoot(y);
+}
+
+// Function to get the node with the largest weight on the path between x and y
+int LinkCutTree::pathMax(int x, int y)
+{
+    makeRoot(x);
+    access(y);
+    splay(y); // y's splay tree now holds exactly the x - y path
+    return nodes[y].maxNode;
+}
+
+// Helper: x is the root of its splay tree when its parent pointer is a path-parent (or null)
+bool LinkCutTree::isSplayRoot(int x) const
+{
+    int p = nodes[x].parent;
+    return p == -1 || (nodes[p].child[0] != x && nodes[p].child[1] != x);
+}
+
+// Helper: hand a pending reversal down to the children
+void LinkCutTree::pushDown(int x)
+{
+    if (nodes[x].flipped)
+    {
+        std::swap(nodes[x].child[0], nodes[x].child[1]);
+        for (int c : nodes[x].child)
+        {
+            if (c != -1)
+            {
+                nodes[c].flipped = !nodes[c].flipped;
+            }
+        }
+        nodes[x].flipped = false;
+    }
+}
+
+// Helper: recompute the aggregate of x from its children
+void LinkCutTree::update(int x)
+{
+    nodes[x].maxNode = x;
+    for (int c : nodes[x].child)
+    {
+        if (c != -1 && nodes[nodes[c].maxNode].weight > nodes[nodes[x].maxNode].weight)
+        {
+            nodes[x].maxNode = nodes[c].maxNode;
+        }
+    }
+}
+
+// Helper: rotate x above its parent
+void LinkCutTree::rotate(int x)
+{
+    int p = nodes[x].parent;
+    int g = nodes[p].parent;
+    int side = (nodes[p].child[1] == x) ? 1 : 0;
+    int moved = nodes[x].child[1 - side];
+
+    if (!isSplayRoot(p))
+    {
+        nodes[g].child[(nodes[g].child[1] == p) ? 1 : 0] = x;
+    }
+    nodes[x].parent = g; // Also carries p's path-parent pointer over to x
+
+    nodes[p].child[side] = moved;
+    if (moved != -1)
+    {
+        nodes[moved].parent = p;
+    }
+    nodes[x].child[1 - side] = p;
+    nodes[p].parent = x;
+
+    update(p);
+    update(x);
+}
+
+// Helper: move x to the root of its splay tree
+void LinkCutTree::splay(int x)
+{
+    // Pending reversals have to be applied top-down before the rotations
+    splayPath.clear();
+    splayPath.push_back(x);
+    for (int y = x; !isSplayRoot(y); y = nodes[y].parent)
+    {
+        splayPath.push_back(nodes[y].parent);
+    }
+    for (auto it = splayPath.rbegin(); it != splayPath.rend(); ++it)
+    {
+        pushDown(*it);
+    }
+
+    while (!isSplayRoot(x))
+    {
+        int p = nodes[x].parent;
+        if (!isSplayRoot(p))
+        {
+            int g = nodes[p].parent;
+            bool zigZig = (nodes[g].child[0] == p) == (nodes[p].child[0] == x);
+            rotate(zigZig ? p : x);
+        }
+        rotate(x);
+    }
+}
+
+// Helper: make the path from the root of x's tree to x the preferred path, with x at its splay root
+void LinkCutTree::access(int x)
+{
+    int last = -1;
+    for (int y = x; y != -1; y = nodes[y].parent)
+    {
+        splay(y);
+        nodes[y].child[1] = last;
+        update(y);
+        last = y;
+    }
+    splay(x);
+}
+
+// Helper: make x the root of its tree by reversing the path from the old root
+void LinkCutTree::makeRoot(int x)
+{
+    access(x);
+    nodes[x].flipped = !nodes[x].flipped;
+}
+
+// Helper: find the root of x's tree (the leftmost node of its preferred path)
+int LinkCutTree::findRoot(int x)
+{
+    access(x);
+    int y = x;
+    pushDown(y);
+    while (nodes[y].child[0] != -1)
+    {
+        y = nodes[y].child[0];
+        pushDown(y);
+    }
+    splay(y);
+    return y;
+}
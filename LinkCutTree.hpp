@@ -0,0 +1,63 @@
+#ifndef LINKCUTTREE_HPP
+#define LINKCUTTREE_HPP
+
+#include <vector>
+
+// Link-cut tree (Sleator-Tarjan) over a forest of weighted nodes. link, cut, connected and pathMax take
+// O(log n) amortized time. To keep weights on edges, model every tree edge as a node of its own placed
+// between its two endpoints, and give the vertex nodes a weight that never wins a pathMax
+class LinkCutTree
+{
+public:
+    // Constructor to create count isolated nodes with the given weight
+    LinkCutTree(int count, int weight);
+
+    // Function to add an isolated node with the given weight and return its id (ids of removed nodes are reused)
+    int addNode(int weight);
+
+    // Function to remove an isolated node (cut all its links first)
+    void removeNode(int x);
+
+    // Function to change the weight of node x
+    void setWeight(int x, int weight);
+
+    // Function to get the weight of node x
+    int getWeight(int x) const;
+
+    // Function to connect the trees of x and y with the link x - y (they must be in different trees)
+    void link(int x, int y);
+
+    // Function to remove the link x - y (it must exist)
+    void cut(int x, int y);
+
+    // Function to check whether x and y are in the same tree
+    bool connected(int x, int y);
+
+    // Function to get the node with the largest weight on the path between x and y (they must be connected)
+    int pathMax(int x, int y);
+
+private:
+    struct Node
+    {
+        int child[2]; // Left and right child in the splay tree, -1 for none
+        int parent;   // Splay parent, or path-parent pointer when this is the root of its splay tree
+        bool flipped; // Pending reversal of this splay subtree
+        int weight;   // Weight of this node
+        int maxNode;  // Node with the largest weight in this splay subtree
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes; // Removed node ids, reused by addNode
+    std::vector<int> splayPath; // Scratch list of the nodes above the one being splayed
+
+    bool isSplayRoot(int x) const;
+    void pushDown(int x);
+    void update(int x);
+    void rotate(int x);
+    void splay(int x);
+    void access(int x);
+    void makeRoot(int x);
+    int findRoot(int x);
+};
+
+#endif // LINKCUTTREE_HPP
@@ -0,0 +1,106 @@
+#include "MSTCache.hpp"
+
+MSTCache::MSTCache(size_t maxBytes) : maxBytes(maxBytes), bytes(0), hits(0), misses(0), evictions(0)
+{
+}
+
+// Function to look up a tree; a hit becomes the most recently used entry
+std::shared_ptr<MSTTree> MSTCache::find(const Graph &graph, int algorithm)
+{
+    Key key = makeKey(graph, algorithm);
+    std::shared_ptr<const Graph> cachedGraph;
+    std::shared_ptr<MSTTree> mst;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            misses++;
+            return nullptr;
+        }
+        cachedGraph = it->second->graph;
+        mst = it->second->mst;
+    }
+
+    // Compare the graphs without holding the lock; the same version's graph needs no comparison. Another graph
+    // with the same key is a miss
+    bool same = cachedGraph.get() == &graph || cachedGraph->hasSameEdges(graph);
+
+    // Measure again without holding the lock: another thread may be building the tree's index right now
+    size_t measured = same ? mst->getMemoryUsage() : 0;
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!same)
+    {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    auto it = index.find(key);
+    if (it != index.end() && it->second->mst == mst)
+    {
+        entries.splice(entries.begin(), entries, it->second);
+        measured += it->second->graphBytes;
+        bytes += measured - it->second->bytes;
+        it->second->bytes = measured;
+        evict();
+    }
+    return mst;
+}
+
+// Function to store a tree as the most recently used entry, replacing one with the same key
+void MSTCache::insert(const std::shared_ptr<const Graph> &graph, int algorithm, const std::shared_ptr<MSTTree> &mst)
+{
+    size_t graphBytes = graph->getMemoryUsage();
+    size_t measured = graphBytes + mst->getMemoryUsage();
+    if (measured > maxBytes)
+    {
+        return;
+    }
+    Key key = makeKey(*graph, algorithm);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        bytes -= it->second->bytes;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front({key, graph, mst, graphBytes, measured});
+    index[key] = entries.begin();
+    bytes += measured;
+    evict();
+}
+
+// Function to get the current statistics
+MSTCache::Stats MSTCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.entries = entries.size();
+    stats.bytes = bytes;
+    stats.maxBytes = maxBytes;
+    return stats;
+}
+
+// Helper function to build the key of graph and algorithm
+MSTCache::Key MSTCache::makeKey(const Graph &graph, int algorithm)
+{
+    return {graph.getNumberOfVertices(), graph.getNumberOfEdges(), graph.getContentHash(), algorithm};
+}
+
+// Helper function to drop least recently used entries until the limit is kept. The trees and graphs themselves
+// live on as long as a session still uses them
+void MSTCache::evict()
+{
+    while (bytes > maxBytes && !entries.empty())
+    {
+        bytes -= entries.back().bytes;
+        index.erase(entries.back().key);
+        entries.pop_back();
+        evictions++;
+    }
+}
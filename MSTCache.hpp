@@ -0,0 +1,104 @@
+#ifndef MSTCACHE_HPP
+#define MSTCACHE_HPP
+
+#include "graph.hpp"
+#include "MST_tree.hpp"
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Server-wide cache of solved MSTs, shared by every client. An entry is found by the content of the graph
+// (Graph::getContentHash() with the vertex and edge counts) and the algorithm, so clients that solve
+// identical graphs, whether uploaded or built edge by edge, get one MSTTree between them. A hash proves
+// nothing, so an entry keeps the graph it was solved from and a hit is only returned for the same graph
+// object or one with the same edges (Graph::hasSameEdges()).
+//
+// Cached trees are never changed: a session that edits its graph copies the MST first (see
+// GraphHandle::writableMst), and neither are the graphs of published versions. The cache holds at most its
+// byte limit of trees and graphs, measured with getMemoryUsage(), and evicts the least recently used ones
+// first. A tree's size is measured again on every hit, since queries build its metrics and distance index later
+class MSTCache
+{
+public:
+    // What the cache holds and how well it does
+    struct Stats
+    {
+        long long hits;      // Lookups that found a tree
+        long long misses;    // Lookups that did not
+        long long evictions; // Trees dropped to stay within the limit
+        size_t entries;      // Trees held
+        size_t bytes;        // Memory of the trees held
+        size_t maxBytes;     // The limit
+    };
+
+    // Constructor of an empty cache holding at most maxBytes of trees
+    explicit MSTCache(size_t maxBytes);
+
+    MSTCache(const MSTCache &) = delete;
+    MSTCache &operator=(const MSTCache &) = delete;
+
+    // Function to look up the MST of graph computed by algorithm (any id the caller uses to tell its
+    // algorithms apart), or null
+    std::shared_ptr<MSTTree> find(const Graph &graph, int algorithm);
+
+    // Function to store the MST of graph computed by algorithm; graph must not change afterwards (the graph of
+    // a published GraphVersion). A tree and graph larger than the whole limit are not kept
+    void insert(const std::shared_ptr<const Graph> &graph, int algorithm, const std::shared_ptr<MSTTree> &mst);
+
+    // Function to get the current statistics
+    Stats getStats() const;
+
+private:
+    // Identifies a graph's content and an algorithm. Different graphs rarely share a key, but may: a hit is
+    // checked against the entry's graph
+    struct Key
+    {
+        int vertices;
+        int edges;
+        unsigned long long contentHash;
+        int algorithm;
+
+        bool operator==(const Key &other) const
+        {
+            return vertices == other.vertices && edges == other.edges && contentHash == other.contentHash &&
+                   algorithm == other.algorithm;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            return static_cast<size_t>(key.contentHash ^ (static_cast<unsigned long long>(key.algorithm) << 56) ^
+                                       static_cast<unsigned long long>(key.vertices) * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const Graph> graph; // The graph mst was solved from
+        std::shared_ptr<MSTTree> mst;
+        size_t graphBytes; // Memory of graph
+        size_t bytes;      // Memory of graph and mst, with mst as it was when last measured
+    };
+
+    mutable std::mutex mtx;  // Guards everything below
+    size_t maxBytes;         // The limit
+    size_t bytes;            // Sum of the entries' bytes
+    long long hits;
+    long long misses;
+    long long evictions;
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index; // The entries by key
+
+    // Helper function to build the key of graph and algorithm
+    static Key makeKey(const Graph &graph, int algorithm);
+
+    // Helper function to drop least recently used entries until the limit is kept
+    void evict();
+};
+
+#endif // MSTCACHE_HPP
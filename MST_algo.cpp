@@ -1,56 +1,166 @@
 #include "MST_algo.hpp"
-#include <queue>
+#include "EdgeList.hpp"
+#include "IndexedHeap.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+#include "SolverWorkspace.hpp"
+#include "UnionFind.hpp"
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <algorithm>
 #include <iostream>
 #include <limits>
-#include <tuple>
 
+// Dense-scan Prim wins once the graph has at least this fraction of all n * (n - 1) / 2 possible edges
+// (measured with `make bench`)
+const double PRIM_DENSE_SCAN_DENSITY = 0.02;
+
+Prim::Prim(Mode mode) : mode(mode)
+{
+}
+
+// Function to tell whether the dense scan is expected to beat the heap on this graph
+bool Prim::prefersDenseScan(const Graph &graph)
+{
+    return prefersDenseScan(graph.getNumberOfVertices(), graph.getNumberOfEdges());
+}
+
+// Function to tell whether the dense scan is expected to beat the heap on a graph of this size
+bool Prim::prefersDenseScan(int numVertices, long long numEdges)
+{
+    double n = numVertices;
+    return numEdges >= PRIM_DENSE_SCAN_DENSITY * n * (n - 1) / 2;
+}
+
+// Prim's Algorithm: dispatch to the requested (or the expected fastest) mode
 MSTTree Prim::computeMST(const Graph &graph)
 {
+    if (graph.getNumberOfVertices() == 0)
+    {
+        return MSTTree(0, std::vector<MSTTree::Edge>());
+    }
+
+    if (mode == DENSE_SCAN || (mode == AUTO && prefersDenseScan(graph)))
+    {
+        return computeDenseScan(graph);
+    }
+    return computeWithHeap(graph);
+}
+
+// Dense-scan Prim: n rounds of "pick the unvisited vertex with the smallest key, relax its row".
+// Both steps are linear scans over contiguous int arrays, done with SIMD kernels (see Simd.hpp)
+MSTTree Prim::computeDenseScan(const Graph &graph)
+{
+    const int infinity = std::numeric_limits<int>::max();
     int n = graph.getNumberOfVertices();
-    std::vector<bool> inMST(n, false);                        // Tracks which vertices are included in the MST
-    std::vector<int> key(n, std::numeric_limits<int>::max()); // Used to pick the minimum weight edge
-    std::vector<int> parent(n, -1);                           // Array to store the constructed MST
-    std::vector<std::pair<int, int>> mstEdges;
+    bool dense = graph.getStorage() == Graph::DENSE;
+    SolverWorkspace &workspace = SolverWorkspace::local();
+    workspace.beginRun();
+    std::vector<int> &key = workspace.ints(0, n, infinity);          // Lightest known edge into each vertex; infinity once it is in the MST
+    std::vector<int> &inTree = workspace.ints(1, n, 0);              // -1 (all bits set) for vertices in the MST, so it works as a lane mask
+    std::vector<int> &parent = workspace.ints(2, n, -1);             // Array to store the constructed MST
+    std::vector<int> &rowBuffer = workspace.ints(3, dense ? 0 : n, 0); // Row of the current vertex when the graph uses SPARSE storage
+    std::vector<int> &parentWeight = workspace.ints(4, n, 0);        // Weight of the edge to parent, taken from key when the vertex joins
+    std::vector<MSTTree::Edge> &mstEdges = workspace.treeEdges(n - 1);
 
     // Start with the first vertex (0)
     key[0] = 0;
+    int nextRoot = 1; // Every vertex below this one has been reached
 
-    // Priority queue to pick the smallest edge based on the key
-    auto compare = [](std::pair<int, int> p1, std::pair<int, int> p2)
+    for (int round = 0; round < n && !isCancelled(); ++round) // A round costs O(n), so every one is a cancellation point
     {
-        return p1.second > p2.second;
-    };
+        int u = simdArgMin(key.data(), n);
+        if (key[u] == infinity)
+        {
+            // The current tree spans its whole component: grow the next tree from the first unreached vertex
+            while (inTree[nextRoot] != 0)
+            {
+                nextRoot++;
+            }
+            u = nextRoot;
+        }
+        parentWeight[u] = key[u];
+        key[u] = infinity; // Out of the running for the next minimum
+        inTree[u] = -1;
 
-    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, decltype(compare)> pq(compare);
-    pq.push({0, 0}); // Insert the first vertex in the priority queue
+        if (dense)
+        {
+            simdRelaxRow(graph.row(u).data(), inTree.data(), key.data(), parent.data(), n, u);
+        }
+        else
+        {
+            // Scatter the edge list into a dense row, relax it, then clear only the entries that were set
+            RowView<Graph::Neighbor> adjacent = graph.neighbors(u);
+            for (const Graph::Neighbor &neighbor : adjacent)
+            {
+                rowBuffer[neighbor.vertex] = neighbor.weight;
+            }
+            simdRelaxRow(rowBuffer.data(), inTree.data(), key.data(), parent.data(), n, u);
+            for (const Graph::Neighbor &neighbor : adjacent)
+            {
+                rowBuffer[neighbor.vertex] = 0;
+            }
+        }
+    }
 
-    while (!pq.empty())
+    // Collect the MST edges based on the parent array
+    for (int v = 1; v < n; ++v)
     {
-        int u = pq.top().first; // Extract the vertex with the smallest key value
-        pq.pop();
+        if (parent[v] != -1)
+        {
+            mstEdges.push_back({parent[v], v, parentWeight[v]});
+        }
+    }
 
-        // Check if this vertex is already included in the MST
-        if (inMST[u])
-            continue;
+    return MSTTree(n, mstEdges);
+}
 
-        // Mark this vertex as included in the MST
-        inMST[u] = true;
+// Heap Prim: an indexed 4-ary heap holds every reached vertex once, keyed by its lightest known edge into the
+// tree, and relaxations lower that key in place. The heap lives in the thread's workspace, so repeated solves reuse it
+MSTTree Prim::computeWithHeap(const Graph &graph)
+{
+    int n = graph.getNumberOfVertices();
+    SolverWorkspace &workspace = SolverWorkspace::local();
+    workspace.beginRun();
+    std::vector<int> &inMST = workspace.ints(0, n, 0);  // Tracks which vertices are included in the MST
+    std::vector<int> &parent = workspace.ints(1, n, -1); // Array to store the constructed MST
+    std::vector<int> &parentWeight = workspace.ints(2, n, 0); // Weight of the edge to parent
+    std::vector<MSTTree::Edge> &mstEdges = workspace.treeEdges(n - 1);
+    IndexedHeap &heap = workspace.heap(n);
 
-        // Update keys and parent for all adjacent vertices of the extracted vertex
-        for (int v = 0; v < n; ++v)
-        {
-            int weight = graph.getAdjacencyMatrix()[u][v];
+    // Start with the first vertex (0)
+    heap.pushOrDecrease(0, 0);
+    int nextRoot = 1; // Every vertex below this one has been reached
 
-            // Only consider edges that are not yet in the MST and have smaller weights
-            if (weight != 0 && !inMST[v] && key[v] > weight)
+    for (int round = 0; round < n; ++round)
+    {
+        if (round % CANCEL_CHECK_INTERVAL == 0 && isCancelled())
+        {
+            break;
+        }
+        if (heap.empty())
+        {
+            // The current tree spans its whole component: grow the next tree from the first unreached vertex
+            while (inMST[nextRoot])
             {
-                key[v] = weight;      // Update the key
-                pq.push({v, key[v]}); // Push the vertex with the updated key into the priority queue
-                parent[v] = u;        // Track the parent of vertex v
+                nextRoot++;
             }
+            heap.pushOrDecrease(nextRoot, 0);
         }
+
+        int u = heap.pop(); // Extract the vertex with the smallest key value
+        inMST[u] = 1;       // Mark this vertex as included in the MST
+
+        // Update keys and parent for all adjacent vertices of the extracted vertex
+        graph.forEachNeighbor(u, [&](int v, int weight)
+                              {
+            // Only consider vertices that are not yet in the MST; the heap ignores keys that are not smaller
+            if (!inMST[v] && heap.pushOrDecrease(v, weight))
+            {
+                parent[v] = u; // Track the parent of vertex v
+                parentWeight[v] = weight;
+            } });
     }
 
     // Collect the MST edges based on the parent array
@@ -58,22 +168,24 @@ MSTTree Prim::computeMST(const Graph &graph)
     {
         if (parent[v] != -1)
         {
-            mstEdges.push_back({parent[v], v});
+            mstEdges.push_back({parent[v], v, parentWeight[v]});
         }
     }
 
     // Return the constructed MST tree
-    return MSTTree(graph, mstEdges);
+    return MSTTree(n, mstEdges);
 }
 
 // Kruskal's Algorithm
 MSTTree Kruskal::computeMST(const Graph &graph)
 {
     int n = graph.getNumberOfVertices();
-    std::vector<std::tuple<int, int, int>> edges; // {weight, u, v}
-    std::vector<std::pair<int, int>> mstEdges;
-    std::vector<int> parent(n);
-    std::vector<int> rank(n, 0);
+    SolverWorkspace &workspace = SolverWorkspace::local();
+    workspace.beginRun();
+    EdgeList &edges = workspace.edges(graph.getNumberOfEdges()); // Weights and endpoints in separate arrays, so the sort streams over the weights only
+    std::vector<MSTTree::Edge> &mstEdges = workspace.treeEdges(n > 0 ? n - 1 : 0);
+    std::vector<int> &parent = workspace.ints(0, n, 0);
+    std::vector<int> &rank = workspace.ints(1, n, 0);
 
     // Initialize the Union-Find structure
     for (int i = 0; i < n; ++i)
@@ -81,36 +193,43 @@ MSTTree Kruskal::computeMST(const Graph &graph)
         parent[i] = i;
     }
 
-    // Collect all edges
+    // Collect all edges, each undirected edge once (u < v)
     for (int u = 0; u < n; ++u)
     {
-        for (int v = u + 1; v < n; ++v)
+        if (u % CANCEL_CHECK_INTERVAL == 0 && isCancelled())
         {
-            int weight = graph.getAdjacencyMatrix()[u][v];
-            if (weight != 0)
-            {
-                edges.push_back({weight, u, v});
-            }
+            break;
         }
+        graph.forEachNeighbor(u, [&](int v, int weight)
+                              {
+            if (u < v)
+            {
+                edges.push(u, v, weight);
+            } });
     }
 
-    // Sort edges by weight
-    std::sort(edges.begin(), edges.end());
+    // Sort edges by weight (radix sort for large edge lists, insertion sort for small ones); each radix pass
+    // is a cancellation point, and the loop below stops right away if the sort was cut short
+    sortByWeight(edges, workspace.sortScratch(edges.size()), getCancelFlag());
 
     // Process each edge in increasing order of weight
-    for (const auto &edge : edges)
+    for (size_t i = 0; i < edges.size(); ++i)
     {
-        int weight, u, v;
-        std::tie(weight, u, v) = edge;
+        if (i % CANCEL_CHECK_INTERVAL == 0 && isCancelled())
+        {
+            break;
+        }
+        int u = edges.from[i];
+        int v = edges.to[i];
 
         if (findParent(u, parent) != findParent(v, parent))
         {
-            mstEdges.push_back({u, v});
+            mstEdges.push_back({u, v, edges.weights[i]});
             unionFind(u, v, parent, rank);
         }
     }
 
-    return MSTTree(graph, mstEdges);
+    return MSTTree(n, mstEdges);
 }
 
 // Helper function for Union-Find (find with path compression)
@@ -144,8 +263,217 @@ void Kruskal::unionFind(int u, int v, std::vector<int> &parent, std::vector<int>
     }
 }
 
+// Borůvka's Algorithm
+Boruvka::Boruvka(int numThreads) : numThreads(numThreads > 0 ? numThreads : defaultThreadCount())
+{
+}
+
+MSTTree Boruvka::computeMST(const Graph &graph)
+{
+    struct Edge
+    {
+        int u, v, weight;
+    };
+
+    int n = graph.getNumberOfVertices();
+    std::vector<Edge> edges;
+    std::vector<MSTTree::Edge> mstEdges;
+    ConcurrentUnionFind components(n);
+
+    // Collect all edges, each undirected edge once (u < v)
+    edges.reserve(graph.getNumberOfEdges());
+    for (int u = 0; u < n; ++u)
+    {
+        graph.forEachNeighbor(u, [&](int v, int weight)
+                              {
+            if (u < v)
+            {
+                edges.push_back({u, v, weight});
+            } });
+    }
+
+    // cheapest[root] holds the index of the lightest edge leaving that component, or -1.
+    // Ties are broken by edge index, so all components agree on one order and no cycle can be chosen
+    std::unique_ptr<std::atomic<int>[]> cheapest(new std::atomic<int>[n]);
+    auto lighter = [&](int a, int b)
+    {
+        return edges[a].weight < edges[b].weight || (edges[a].weight == edges[b].weight && a < b);
+    };
+    auto offer = [&](int root, int edge)
+    {
+        int current = cheapest[root].load(std::memory_order_relaxed);
+        while ((current == -1 || lighter(edge, current)) &&
+               !cheapest[root].compare_exchange_weak(current, edge, std::memory_order_relaxed))
+        {
+        }
+    };
+
+    std::vector<std::vector<Edge>> survivors(numThreads);
+    std::vector<std::vector<MSTTree::Edge>> picked(numThreads);
+
+    while (!edges.empty() && !isCancelled()) // One cancellation point per round
+    {
+        parallelFor(numThreads, static_cast<size_t>(n), [&](size_t begin, size_t end, int)
+                    {
+            for (size_t i = begin; i < end; ++i)
+            {
+                cheapest[i].store(-1, std::memory_order_relaxed);
+            } });
+
+        // Phase 1: every edge offers itself to the components at both of its ends
+        parallelFor(numThreads, edges.size(), [&](size_t begin, size_t end, int)
+                    {
+            for (size_t i = begin; i < end; ++i)
+            {
+                int rootU = components.find(edges[i].u);
+                int rootV = components.find(edges[i].v);
+                if (rootU != rootV)
+                {
+                    offer(rootU, static_cast<int>(i));
+                    offer(rootV, static_cast<int>(i));
+                }
+            } });
+
+        // Phase 2: contract every component along its cheapest edge. When two components picked the
+        // same edge only one unite() succeeds, so each tree edge is recorded exactly once
+        parallelFor(numThreads, static_cast<size_t>(n), [&](size_t begin, size_t end, int thread)
+                    {
+            for (size_t root = begin; root < end; ++root)
+            {
+                int edge = cheapest[root].load(std::memory_order_relaxed);
+                if (edge != -1 && components.unite(edges[edge].u, edges[edge].v))
+                {
+                    picked[thread].push_back({edges[edge].u, edges[edge].v, edges[edge].weight});
+                }
+            } });
+
+        bool merged = false;
+        for (auto &treeEdges : picked)
+        {
+            merged = merged || !treeEdges.empty();
+            mstEdges.insert(mstEdges.end(), treeEdges.begin(), treeEdges.end());
+            treeEdges.clear();
+        }
+        if (!merged)
+        {
+            break; // Every remaining component is already a whole connected component of the graph
+        }
+
+        // Phase 3: drop the edges that now lie inside a single component
+        parallelFor(numThreads, edges.size(), [&](size_t begin, size_t end, int thread)
+                    {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!components.connected(edges[i].u, edges[i].v))
+                {
+                    survivors[thread].push_back(edges[i]);
+                }
+            } });
+
+        edges.clear();
+        for (auto &kept : survivors)
+        {
+            edges.insert(edges.end(), kept.begin(), kept.end());
+            kept.clear();
+        }
+    }
+
+    return MSTTree(n, mstEdges);
+}
+
+// Filter-Kruskal
+FilterKruskal::FilterKruskal(int numThreads)
+    : numThreads(numThreads > 0 ? numThreads : defaultThreadCount()), componentsLeft(0)
+{
+}
+
+MSTTree FilterKruskal::computeMST(const Graph &graph)
+{
+    int n = graph.getNumberOfVertices();
+    std::vector<Edge> edges;
+    ConcurrentUnionFind components(n);
+    unsigned int seed = 12345; // Fixed seed, so a graph always gets the same pivots
+
+    // Collect all edges, each undirected edge once (u < v)
+    edges.reserve(graph.getNumberOfEdges());
+    for (int u = 0; u < n; ++u)
+    {
+        graph.forEachNeighbor(u, [&](int v, int weight)
+                              {
+            if (u < v)
+            {
+                edges.push_back({weight, u, v});
+            } });
+    }
+
+    mstEdges.clear();
+    componentsLeft = n;
+    // Below this size partitioning costs more than it saves, so the edges are sorted directly
+    size_t baseCaseSize = std::max(static_cast<size_t>(n), 4 * PARALLEL_MIN_CHUNK);
+    filterKruskal(edges, 0, edges.size(), components, baseCaseSize, seed);
+
+    scratch.clear();
+    scratch.shrink_to_fit();
+    return MSTTree(n, mstEdges);
+}
+
+// Helper function that adds the MST edges of edges[begin, end) to mstEdges. Every edge lighter than those in
+// the range has already been processed, so the range can be solved on its own
+void FilterKruskal::filterKruskal(std::vector<Edge> &edges, size_t begin, size_t end, ConcurrentUnionFind &components,
+                                  size_t baseCaseSize, unsigned int &seed)
+{
+    if (begin == end || componentsLeft <= 1 || isCancelled())
+    {
+        return; // Nothing left, the spanning tree is already complete, or the computation was cancelled
+    }
+
+    auto lighter = [](const Edge &a, const Edge &b)
+    {
+        return a.weight < b.weight;
+    };
+
+    // Pivot: median weight of three sampled edges
+    int samples[3];
+    for (int &sample : samples)
+    {
+        seed = seed * 1103515245u + 12345u;
+        sample = edges[begin + (seed >> 8) % (end - begin)].weight;
+    }
+    std::sort(samples, samples + 3);
+    int pivot = samples[1];
+
+    size_t split = end;
+    if (end - begin > baseCaseSize)
+    {
+        split = parallelPartition(numThreads, edges, begin, end, [pivot](const Edge &edge)
+                                  { return edge.weight <= pivot; }, scratch);
+    }
+
+    if (split == end)
+    {
+        // Base case (small range, or every edge is at most the pivot): plain Kruskal on the sorted range
+        parallelSort(numThreads, edges.begin() + begin, end - begin, lighter);
+        for (size_t i = begin; i < end && componentsLeft > 1; ++i)
+        {
+            if (components.unite(edges[i].u, edges[i].v))
+            {
+                mstEdges.push_back({edges[i].u, edges[i].v, edges[i].weight});
+                componentsLeft--;
+            }
+        }
+        return;
+    }
+
+    filterKruskal(edges, begin, split, components, baseCaseSize, seed);
+
+    // Filter: heavy edges inside an existing component can never join the MST, so drop them before recursing
+    size_t kept = parallelPartition(numThreads, edges, split, end, [&components](const Edge &edge)
+                                    { return !components.connected(edge.u, edge.v); }, scratch);
+    filterKruskal(edges, split, kept, components, baseCaseSize, seed);
+}
+
 // MSTFactory: Factory method to create MST algorithm
-MSTAlgo *MSTFactory::createMSTAlgorithm(MSTFactory::AlgorithmType type)
+MSTAlgo *MSTFactory::createMSTAlgorithm(MSTFactory::AlgorithmType type, int numThreads)
 {
     if (type == PRIM)
     {
@@ -155,5 +483,30 @@ MSTAlgo *MSTFactory::createMSTAlgorithm(MSTFactory::AlgorithmType type)
     {
         return new Kruskal();
     }
+    else if (type == BORUVKA)
+    {
+        return new Boruvka(numThreads);
+    }
+    else if (type == FILTER_KRUSKAL)
+    {
+        return new FilterKruskal(numThreads);
+    }
     return nullptr;
 }
+
+// MSTFactory: name clients use for an algorithm
+const char *MSTFactory::algorithmName(MSTFactory::AlgorithmType type)
+{
+    switch (type)
+    {
+    case PRIM:
+        return "prim";
+    case KRUSKAL:
+        return "kruskal";
+    case BORUVKA:
+        return "boruvka";
+    case FILTER_KRUSKAL:
+        return "filter-kruskal";
+    }
+    return "unknown";
+}
@@ -6,21 +6,66 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 
+class ConcurrentUnionFind;
+
 // Abstract base class for MST Algorithm
 class MSTAlgo
 {
 public:
+    MSTAlgo() : cancelFlag(nullptr) {}
     virtual MSTTree computeMST(const Graph &graph) = 0; // Pure virtual function to compute the MST
     virtual ~MSTAlgo() {}
+
+    // Function to let another thread stop the computation: once *flag is set, computeMST() returns early, at
+    // its next cancellation point, with a partial tree that the caller discards. Null (the default) never stops
+    void setCancelFlag(const std::atomic<bool> *flag) { cancelFlag = flag; }
+
+protected:
+    // Function to check at a cancellation point whether the computation should stop
+    bool isCancelled() const { return cancelFlag && cancelFlag->load(std::memory_order_relaxed); }
+
+    // Function to get the flag, for algorithms that hand parts of the work to other algorithms
+    const std::atomic<bool> *getCancelFlag() const { return cancelFlag; }
+
+    // Iterations of a cheap loop between two cancellation points
+    static const size_t CANCEL_CHECK_INTERVAL = 4096;
+
+private:
+    const std::atomic<bool> *cancelFlag; // Set by another thread to stop the computation, or null
 };
 
-// Prim's Algorithm implementation
+// Prim's Algorithm implementation. When a tree cannot grow any further, the next one starts from the first
+// unreached vertex, so a disconnected graph gets a minimum spanning forest rather than one partial tree
 class Prim : public MSTAlgo
 {
 public:
+    enum Mode
+    {
+        AUTO,       // Pick DENSE_SCAN or HEAP from the edge density of the graph
+        DENSE_SCAN, // O(n^2): keep all keys in one array and scan it (vectorized) for the minimum
+        HEAP        // O(E log n): indexed 4-ary heap of candidate vertices with decrease-key
+    };
+
+    // Constructor; the mode is normally left to AUTO
+    explicit Prim(Mode mode = AUTO);
+
+    // Function to tell whether the dense scan is expected to beat the heap on this graph
+    static bool prefersDenseScan(const Graph &graph);
+
+    // Function to tell whether the dense scan is expected to beat the heap on a graph of this size
+    static bool prefersDenseScan(int numVertices, long long numEdges);
+
     MSTTree computeMST(const Graph &graph) override;
+
+private:
+    Mode mode; // The requested mode
+
+    // Helper functions implementing the two modes
+    MSTTree computeDenseScan(const Graph &graph);
+    MSTTree computeWithHeap(const Graph &graph);
 };
 
 // Kruskal's Algorithm implementation
@@ -35,6 +80,47 @@ public:
     MSTTree computeMST(const Graph &graph) override;
 };
 
+// Borůvka's Algorithm implementation: every round, all components pick their cheapest outgoing edge in
+// parallel and are contracted along those edges, so at most log2(n) rounds are needed
+class Boruvka : public MSTAlgo
+{
+private:
+    int numThreads; // Number of threads used for each parallel phase
+
+public:
+    // Constructor; 0 threads means one per hardware core
+    explicit Boruvka(int numThreads = 0);
+
+    MSTTree computeMST(const Graph &graph) override;
+};
+
+// Filter-Kruskal: Kruskal's algorithm that partitions the edges around a pivot weight, solves the light
+// half first, and drops every heavy edge whose endpoints are already connected before sorting the rest.
+// Partitioning, filtering and sorting all run in parallel
+class FilterKruskal : public MSTAlgo
+{
+private:
+    struct Edge
+    {
+        int weight, u, v;
+    };
+
+    int numThreads;                              // Number of threads used for each parallel phase
+    std::vector<Edge> scratch;                   // Output buffer of the parallel partitions
+    std::vector<MSTTree::Edge> mstEdges;         // Edges picked so far by the running computation
+    int componentsLeft;                          // Components of the current forest, 1 means done
+
+    // Helper function that adds the MST edges of edges[begin, end) to mstEdges
+    void filterKruskal(std::vector<Edge> &edges, size_t begin, size_t end, ConcurrentUnionFind &components,
+                       size_t baseCaseSize, unsigned int &seed);
+
+public:
+    // Constructor; 0 threads means one per hardware core
+    explicit FilterKruskal(int numThreads = 0);
+
+    MSTTree computeMST(const Graph &graph) override;
+};
+
 // Factory class to select the algorithm dynamically
 class MSTFactory
 {
@@ -42,11 +128,20 @@ public:
     enum AlgorithmType
     {
         PRIM,
-        KRUSKAL
+        KRUSKAL,
+        BORUVKA,
+        FILTER_KRUSKAL
     };
 
-    // Static method to create an MST algorithm based on the request
-    static MSTAlgo *createMSTAlgorithm(AlgorithmType type);
+    // Number of algorithm types above
+    static const int ALGORITHM_COUNT = 4;
+
+    // Static method to create an MST algorithm based on the request.
+    // numThreads is used by the parallel algorithms only; 0 means one thread per hardware core
+    static MSTAlgo *createMSTAlgorithm(AlgorithmType type, int numThreads = 0);
+
+    // Static method to get the name clients use for an algorithm (as in "solve <name>")
+    static const char *algorithmName(AlgorithmType type);
 };
 
 #endif
@@ -1,68 +1,242 @@
 #include "MST_tree.hpp"
+#include "SolverWorkspace.hpp"
+#include "EdgeList.hpp"
+#include "UnionFind.hpp"
+#include "Parallel.hpp"
 #include <iostream>
-#include <cmath>
 #include <limits>
 
-// Constructor to initialize the MST tree from a graph and the MST edges
-MSTTree::MSTTree(const Graph &graph, const std::vector<std::pair<int, int>> &mstEdges)
-    : mstGraph(graph.getNumberOfVertices()), totalWeight(0), edges(mstEdges)
+// Constructor to initialize the MST tree from its weighted edges. A tree has no duplicate edges, so they go
+// into the MST graph without the duplicate lookup of addEdge() (O(1) each instead of O(deg))
+MSTTree::MSTTree(int numVertices, const std::vector<Edge> &mstEdges)
+    : mstGraph(numVertices), totalWeight(0), edges(mstEdges),
+      diameterCached(false), diameter(0), diameterEnds(-1, -1), averageCached(false), averageDistance(0),
+      componentsCached(false),
+      lcaBuilt(false), sideStamp(0)
 {
-
-    // Copy only the edges in the MST into the MST graph
-    for (const auto &edge : mstEdges)
+    for (const Edge &edge : mstEdges)
     {
-        int u = edge.first;
-        int v = edge.second;
-        int weight = graph.getAdjacencyMatrix()[u][v];
-        mstGraph.addEdge(u, v, weight);
-        totalWeight += weight;
+        mstGraph.addNewEdge(edge.u, edge.v, edge.weight);
+        totalWeight += edge.weight;
     }
 }
 
+// Copy constructor: the copy gets its own link-cut tree; the caches are read under the original's lock,
+// since other threads may be filling them
+MSTTree::MSTTree(const MSTTree &other)
+    : mstGraph(other.mstGraph), totalWeight(other.totalWeight), edges(other.edges),
+      diameterCached(false), diameter(0), diameterEnds(-1, -1), averageCached(false), averageDistance(0),
+      componentsCached(false),
+      lcaBuilt(false),
+      linkCut(other.linkCut ? new LinkCutTree(*other.linkCut) : nullptr), treeEdgeSlots(other.treeEdgeSlots),
+      nodeEnds(other.nodeEnds), sideMark(other.sideMark), sideStamp(other.sideStamp)
+{
+    std::lock_guard<std::mutex> lock(other.cacheMutex.mutex);
+    diameterCached = other.diameterCached;
+    diameter = other.diameter;
+    diameterEnds = other.diameterEnds;
+    averageCached = other.averageCached;
+    averageDistance = other.averageDistance;
+    componentsCached = other.componentsCached;
+    components = other.components;
+}
+
 // Function to calculate the total weight of the MST
 int MSTTree::getTotalWeight() const
 {
     return totalWeight;
 }
 
-// Function to calculate the longest distance between two vertices in the MST
+// Function to calculate the longest distance between two vertices in the MST (the tree diameter).
+// Two traversals per component: the vertex farthest from any start vertex is one end of a longest path,
+// and the vertex farthest from that one is the other end. O(n) time and memory
 int MSTTree::getLongestDistance() const
 {
-    auto dist = floydWarshall();
-    int longest = 0;
-    for (int i = 0; i < mstGraph.getNumberOfVertices(); ++i)
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    if (diameterCached)
     {
-        for (int j = 0; j < mstGraph.getNumberOfVertices(); ++j)
+        return diameter;
+    }
+
+    int n = mstGraph.getNumberOfVertices();
+    SolverWorkspace &workspace = SolverWorkspace::local(); // Scratch buffers, reused across queries
+    std::vector<long long> &dist = workspace.longs(0, n, 0);
+    std::vector<long long> &distFromEnd = workspace.longs(1, n, 0);
+    std::vector<int> &visited = workspace.ints(3, n, 0);
+    std::vector<int> &visitedFromEnd = workspace.ints(4, n, 0);
+    std::vector<int> &parent = workspace.ints(0, n, -1);
+    std::vector<int> &order = workspace.emptyInts(1, n);
+    std::vector<int> &endOrder = workspace.emptyInts(2, n);
+    long long longest = 0;
+    std::pair<int, int> ends(-1, -1);
+
+    for (int start = 0; start < n; ++start)
+    {
+        if (visited[start])
+        {
+            continue; // Already covered by an earlier component
+        }
+
+        // First pass: find the vertex farthest from the start vertex
+        size_t first = order.size();
+        traverse(start, visited, dist, parent, order);
+        int end = start;
+        for (size_t i = first; i < order.size(); ++i)
         {
-            if (dist[i][j] != std::numeric_limits<int>::max())
+            if (dist[order[i]] > dist[end])
             {
-                longest = std::max(longest, dist[i][j]);
+                end = order[i];
+            }
+        }
+
+        // Second pass: the farthest vertex from that end gives the diameter of this component
+        endOrder.clear();
+        traverse(end, visitedFromEnd, distFromEnd, parent, endOrder);
+        for (int vertex : endOrder)
+        {
+            if (ends.first == -1 || distFromEnd[vertex] > longest)
+            {
+                longest = distFromEnd[vertex];
+                ends = std::make_pair(end, vertex);
             }
         }
     }
-    return longest;
+
+    diameter = static_cast<int>(longest);
+    diameterEnds = ends;
+    diameterCached = true;
+    return diameter;
 }
 
-// Function to calculate the average distance between any two vertices in the MST
-double MSTTree::getAverageDistance() const
+// Function to get the two vertices at the ends of the longest path in the MST
+std::pair<int, int> MSTTree::getDiameterEndpoints() const
 {
-    auto dist = floydWarshall();
-    double totalDistance = 0;
-    int count = 0;
+    getLongestDistance(); // Fills the cache if needed
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    return diameterEnds;
+}
 
-    for (int i = 0; i < mstGraph.getNumberOfVertices(); ++i)
+// Function to summarize every tree of the MST: the first traversal of a component sums its edge weights
+// (the distance gained over each parent edge) and finds one end of its longest path, the second one measures
+// that path. Components are found in increasing vertex order, so each starts at its smallest vertex. O(n)
+const std::vector<MSTTree::Component> &MSTTree::getComponents() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    if (componentsCached)
     {
-        for (int j = i; j < mstGraph.getNumberOfVertices(); ++j)
+        return components;
+    }
+
+    int n = mstGraph.getNumberOfVertices();
+    SolverWorkspace &workspace = SolverWorkspace::local(); // Scratch buffers, reused across queries
+    std::vector<long long> &dist = workspace.longs(0, n, 0);
+    std::vector<long long> &distFromEnd = workspace.longs(1, n, 0);
+    std::vector<int> &visited = workspace.ints(3, n, 0);
+    std::vector<int> &visitedFromEnd = workspace.ints(4, n, 0);
+    std::vector<int> &parent = workspace.ints(0, n, -1);
+    std::vector<int> &order = workspace.emptyInts(1, n);
+    std::vector<int> &endOrder = workspace.emptyInts(2, n);
+    components.clear();
+
+    for (int start = 0; start < n; ++start)
+    {
+        if (visited[start])
+        {
+            continue; // Already covered by an earlier component
+        }
+
+        size_t first = order.size();
+        traverse(start, visited, dist, parent, order);
+        long long weight = 0;
+        int end = start;
+        for (size_t i = first; i < order.size(); ++i)
         {
-            if (dist[i][j] != std::numeric_limits<int>::max())
+            int vertex = order[i];
+            if (parent[vertex] != -1)
             {
-                totalDistance += dist[i][j];
-                count++;
+                weight += dist[vertex] - dist[parent[vertex]];
             }
+            if (dist[vertex] > dist[end])
+            {
+                end = vertex;
+            }
+        }
+
+        endOrder.clear();
+        traverse(end, visitedFromEnd, distFromEnd, parent, endOrder);
+        long long longest = 0;
+        for (int vertex : endOrder)
+        {
+            longest = std::max(longest, distFromEnd[vertex]);
+        }
+
+        Component summary;
+        summary.representative = start;
+        summary.vertices = static_cast<int>(order.size() - first);
+        summary.weight = static_cast<int>(weight);
+        summary.diameter = static_cast<int>(longest);
+        components.push_back(summary);
+    }
+
+    componentsCached = true;
+    return components;
+}
+
+// Function to fill the component cache with summaries computed elsewhere
+void MSTTree::setComponents(std::vector<Component> summaries)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    components = std::move(summaries);
+    componentsCached = true;
+}
+
+// Function to calculate the average distance between any two vertices in the MST.
+// Every pair (i, j) with i <= j in the same component counts once. A tree edge of weight w that splits
+// its component of c vertices into s and c - s lies on exactly s * (c - s) paths, so the sum of all
+// distances comes from subtree sizes alone. O(n) time and memory
+double MSTTree::getAverageDistance() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    if (averageCached)
+    {
+        return averageDistance;
+    }
+
+    int n = mstGraph.getNumberOfVertices();
+    SolverWorkspace &workspace = SolverWorkspace::local(); // Scratch buffers, reused across queries
+    std::vector<long long> &dist = workspace.longs(0, n, 0);
+    std::vector<int> &visited = workspace.ints(3, n, 0);
+    std::vector<int> &parent = workspace.ints(0, n, -1);
+    std::vector<long long> &subtreeSize = workspace.longs(2, n, 1);
+    std::vector<int> &order = workspace.emptyInts(1, n);
+    double totalDistance = 0;
+    double count = 0;
+
+    for (int root = 0; root < n; ++root)
+    {
+        if (visited[root])
+        {
+            continue; // Already covered by an earlier component
+        }
+
+        size_t first = order.size();
+        traverse(root, visited, dist, parent, order);
+        long long componentSize = static_cast<long long>(order.size() - first);
+        count += static_cast<double>(componentSize) * (componentSize + 1) / 2;
+
+        // Children come after their parents in order, so walking it backwards sees every subtree complete
+        for (size_t i = order.size(); i-- > first + 1;)
+        {
+            int child = order[i];
+            long long weight = dist[child] - dist[parent[child]]; // The parent edge, without an O(deg) lookup
+            totalDistance += static_cast<double>(weight) * subtreeSize[child] * (componentSize - subtreeSize[child]);
+            subtreeSize[parent[child]] += subtreeSize[child];
         }
     }
 
-    return (count == 0) ? 0 : totalDistance / count;
+    averageDistance = (count == 0) ? 0 : totalDistance / count;
+    averageCached = true;
+    return averageDistance;
 }
 
 // Function to find the shortest distance between two vertices in the MST (i ≠ j)
@@ -82,84 +256,461 @@ int MSTTree::getShortestDistance(int u, int v) const
         return -1; // Return -1 to indicate an error
     }
 
-    // Run Floyd-Warshall algorithm on the MST adjacency matrix
-    auto dist = floydWarshall();
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+        if (!lcaBuilt)
+        {
+            buildLcaIndex(); // Built once, then reused by every following query
+        }
+    }
 
-    // Check if there is no path between u and v in the MST (i.e., distance is infinity)
-    if (dist[u][v] == std::numeric_limits<int>::max())
+    // Check if there is no path between u and v in the MST (different components)
+    if (component[u] != component[v])
     {
         std::cout << "No path exists between vertices " << u << " and " << v << " in the MST." << std::endl;
         return -1; // Return -1 or another value to indicate no path exists
     }
 
-    return dist[u][v]; // Return the shortest distance between u and v
+    // In a tree the only path goes through the lowest common ancestor
+    int ancestor = lowestCommonAncestor(u, v);
+    return static_cast<int>(rootDistance[u] + rootDistance[v] - 2 * rootDistance[ancestor]);
 }
 
-// Function to print the MST tree (for debugging)
-void MSTTree::printMST() const
+// Function to answer many shortest-distance queries with one distance index
+void MSTTree::getShortestDistances(const std::vector<std::pair<int, int>> &pairs, std::vector<long long> &distances,
+                                   int numThreads) const
 {
-    mstGraph.printAdjacencyMatrix();
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+        if (!lcaBuilt)
+        {
+            buildLcaIndex(); // Before the threads start: from here on the queries are read-only
+        }
+    }
+
+    int n = mstGraph.getNumberOfVertices();
+    distances.resize(pairs.size());
+    parallelFor(numThreads, pairs.size(), [&](size_t begin, size_t end, int)
+                {
+        for (size_t i = begin; i < end; ++i)
+        {
+            int u = pairs[i].first;
+            int v = pairs[i].second;
+            if (u < 0 || v < 0 || u >= n || v >= n || u == v || component[u] != component[v])
+            {
+                distances[i] = -1;
+                continue;
+            }
+            distances[i] = rootDistance[u] + rootDistance[v] - 2 * rootDistance[lowestCommonAncestor(u, v)];
+        } });
+}
+
+// Functions to tell whether the next query will be answered from the cache
+bool MSTTree::isLongestDistanceCached() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    return diameterCached;
+}
+
+bool MSTTree::isAverageDistanceCached() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    return averageCached;
+}
+
+bool MSTTree::isComponentsCached() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    return componentsCached;
+}
+
+bool MSTTree::isDistanceIndexBuilt() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    return lcaBuilt;
+}
+
+// Function to drop every memoized metric and index
+void MSTTree::invalidateCache()
+{
+    diameterCached = false;
+    averageCached = false;
+    componentsCached = false;
+    components.clear();
+    lcaBuilt = false;
+    component.clear();
+    depth.clear();
+    rootDistance.clear();
+    firstVisit.clear();
+    lcaTable.clear();
 }
 
-// Helper function to calculate all-pairs shortest path using Floyd-Warshall algorithm on the MST
-std::vector<std::vector<int>> MSTTree::floydWarshall() const
+// Function to switch on dynamic mode: every tree edge becomes a link-cut node between its endpoints, and the
+// graph edges joining different trees are added Kruskal-style (Prim leaves other components unspanned)
+void MSTTree::enableDynamicMode(const Graph &graph)
 {
     int n = mstGraph.getNumberOfVertices();
+    linkCut.reset(new LinkCutTree(n, std::numeric_limits<int>::min())); // Vertex nodes never win a pathMax
+    nodeEnds.assign(n, std::make_pair(-1, -1));
+    sideMark.assign(n, 0);
+    sideStamp = 0;
+    treeEdgeSlots.clear();
 
-    // Ensure we have a valid graph
-    if (n == 0)
+    // A plain union-find answers "same tree?" much faster than the link-cut tree during this bulk pass
+    ConcurrentUnionFind trees(n);
+    std::vector<Edge> treeEdges;
+    treeEdges.swap(edges);
+    totalWeight = 0;
+    for (const Edge &edge : treeEdges)
     {
-        std::cerr << "Error: Graph has no vertices.\n";
-        return std::vector<std::vector<int>>(); // Return empty result
+        linkTreeEdge(edge.u, edge.v, edge.weight, true); // mstGraph already has it
+        trees.unite(edge.u, edge.v);
     }
 
-    auto adjMat = mstGraph.getAdjacencyMatrix();
-    std::vector<std::vector<int>> dist(n, std::vector<int>(n, std::numeric_limits<int>::max()));
+    EdgeList candidates;
+    for (int u = 0; u < n; ++u)
+    {
+        graph.forEachNeighbor(u, [&](int v, int weight)
+                              {
+            if (u < v && !trees.connected(u, v))
+            {
+                candidates.push(u, v, weight);
+            } });
+    }
+    sortByWeight(candidates);
+    bool grew = false;
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (trees.unite(candidates.from[i], candidates.to[i]))
+        {
+            linkTreeEdge(candidates.from[i], candidates.to[i], candidates.weights[i]);
+            grew = true;
+        }
+    }
+    if (grew)
+    {
+        invalidateCache();
+    }
+}
 
-    // Initialize distances: If there's an edge in the MST, set the distance to the weight of that edge
-    for (const auto &edge : edges)
+// Function to check whether dynamic mode is on
+bool MSTTree::isDynamic() const
+{
+    return linkCut != nullptr;
+}
+
+// Function to update the MST after the edge (u, v) of graph changed. Cases:
+// - tree edge that got lighter: only its weight changes
+// - tree edge that was removed or got heavier: cut it, then reconnect through the lightest edge between the halves
+// - any other edge: if it joins two trees, link it; if it closes a cycle whose heaviest edge is heavier, swap them
+bool MSTTree::onEdgeChanged(const Graph &graph, int u, int v)
+{
+    int n = mstGraph.getNumberOfVertices();
+    if (!linkCut || u == v || u < 0 || v < 0 || u >= n || v >= n)
     {
-        int u = edge.first;
-        int v = edge.second;
+        return false;
+    }
 
-        // Check that u and v are valid indices
-        if (u < 0 || v < 0 || u >= n || v >= n)
+    int weight = graph.weight(u, v); // 0 when the edge was removed
+    auto slot = treeEdgeSlots.find(edgeKey(u, v));
+    if (slot != treeEdgeSlots.end())
+    {
+        int node = slot->second.node;
+        int oldWeight = linkCut->getWeight(node);
+        if (weight == oldWeight)
         {
-            std::cerr << "Error: Invalid edge between vertices " << u << " and " << v << ".\n";
-            continue;
+            return false;
         }
+        if (weight != 0 && weight < oldWeight)
+        {
+            linkCut->setWeight(node, weight);
+            edges[slot->second.position].weight = weight;
+            mstGraph.addEdge(u, v, weight);
+            totalWeight += weight - oldWeight;
+        }
+        else
+        {
+            cutTreeEdge(u, v);
+            reconnect(graph, u, v); // May pick (u, v) again with its new weight
+        }
+        invalidateCache();
+        return true;
+    }
+
+    if (weight == 0)
+    {
+        return false; // A non-tree edge disappeared
+    }
 
-        int weight = adjMat[u][v];
-        dist[u][v] = weight;
-        dist[v][u] = weight; // Undirected, so make it symmetric
+    if (!linkCut->connected(u, v))
+    {
+        linkTreeEdge(u, v, weight);
+        invalidateCache();
+        return true;
     }
 
-    // The distance from any vertex to itself is 0
-    for (int i = 0; i < n; ++i)
+    // Cycle check: the new edge replaces the heaviest tree edge on the u - v path if it is lighter
+    int heaviest = linkCut->pathMax(u, v);
+    if (linkCut->getWeight(heaviest) <= weight)
     {
-        dist[i][i] = 0;
+        return false;
     }
+    std::pair<int, int> ends = nodeEnds[heaviest];
+    cutTreeEdge(ends.first, ends.second);
+    linkTreeEdge(u, v, weight);
+    invalidateCache();
+    return true;
+}
 
-    // Floyd-Warshall algorithm to compute shortest paths in the MST
-    for (int k = 0; k < n; ++k)
+// Helper function to build the map key of the undirected edge (u, v)
+long long MSTTree::edgeKey(int u, int v)
+{
+    if (u > v)
     {
-        for (int i = 0; i < n; ++i)
+        std::swap(u, v);
+    }
+    return (static_cast<long long>(u) << 32) | static_cast<unsigned int>(v);
+}
+
+// Helper function to add the edge (u, v) to the tree
+void MSTTree::linkTreeEdge(int u, int v, int weight, bool inGraph)
+{
+    int node = linkCut->addNode(weight);
+    linkCut->link(u, node);
+    linkCut->link(node, v);
+    if (node >= static_cast<int>(nodeEnds.size()))
+    {
+        nodeEnds.resize(node + 1);
+    }
+    nodeEnds[node] = std::make_pair(u, v);
+
+    treeEdgeSlots[edgeKey(u, v)] = {node, edges.size()};
+    edges.push_back({u, v, weight});
+    if (!inGraph)
+    {
+        mstGraph.addEdge(u, v, weight);
+    }
+    totalWeight += weight;
+}
+
+// Helper function to remove the edge (u, v) from the tree
+void MSTTree::cutTreeEdge(int u, int v)
+{
+    auto found = treeEdgeSlots.find(edgeKey(u, v));
+    TreeEdgeSlot slot = found->second;
+    treeEdgeSlots.erase(found);
+
+    totalWeight -= linkCut->getWeight(slot.node);
+    linkCut->cut(u, slot.node);
+    linkCut->cut(slot.node, v);
+    linkCut->removeNode(slot.node);
+
+    // The order of edges does not matter, so move the last edge into the hole
+    Edge last = edges.back();
+    edges.pop_back();
+    if (slot.position < edges.size())
+    {
+        edges[slot.position] = last;
+        treeEdgeSlots[edgeKey(last.u, last.v)].position = slot.position;
+    }
+    mstGraph.removeEdge(u, v);
+}
+
+// Helper function to reconnect the trees of u and v. Both trees are explored one vertex at a time in turns,
+// so the search stops as soon as the smaller one is complete; only edges leaving that smaller tree are then
+// scanned. Costs O(size + degrees of the smaller side) instead of a rebuild over all edges
+void MSTTree::reconnect(const Graph &graph, int u, int v)
+{
+    int markU = ++sideStamp;
+    int markV = ++sideStamp;
+    std::vector<int> sideU{u}, sideV{v};
+    sideMark[u] = markU;
+    sideMark[v] = markV;
+
+    auto expand = [&](std::vector<int> &side, size_t &next, int mark)
+    {
+        int x = side[next++];
+        mstGraph.forEachNeighbor(x, [&](int y, int)
+                                 {
+            if (sideMark[y] != mark)
+            {
+                sideMark[y] = mark;
+                side.push_back(y);
+            } });
+    };
+
+    size_t nextU = 0, nextV = 0;
+    while (nextU < sideU.size() && nextV < sideV.size())
+    {
+        expand(sideU, nextU, markU);
+        if (nextU < sideU.size())
         {
-            for (int j = 0; j < n; ++j)
+            expand(sideV, nextV, markV);
+        }
+    }
+    bool uSmaller = nextU == sideU.size();
+    const std::vector<int> &smaller = uSmaller ? sideU : sideV;
+    int mark = uSmaller ? markU : markV;
+
+    // Every graph edge leaving the smaller tree ends in the other one, since together they span a component
+    int bestFrom = -1, bestTo = -1, bestWeight = 0;
+    for (int x : smaller)
+    {
+        graph.forEachNeighbor(x, [&](int y, int weight)
+                              {
+            if (sideMark[y] != mark && (bestFrom == -1 || weight < bestWeight))
+            {
+                bestFrom = x;
+                bestTo = y;
+                bestWeight = weight;
+            } });
+    }
+
+    if (bestFrom != -1)
+    {
+        linkTreeEdge(bestFrom, bestTo, bestWeight);
+    }
+}
+
+// Function to estimate the memory the MST takes; the dynamic-mode structures are left out (they are only
+// filled in by changes, which a shared MST never gets)
+size_t MSTTree::getMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex.mutex);
+    size_t bytes = sizeof(MSTTree) - sizeof(Graph) + mstGraph.getMemoryUsage();
+    bytes += edges.capacity() * sizeof(edges[0]) + components.capacity() * sizeof(Component);
+    bytes += (component.capacity() + depth.capacity() + firstVisit.capacity()) * sizeof(int);
+    bytes += rootDistance.capacity() * sizeof(long long);
+    for (const std::vector<int> &level : lcaTable)
+    {
+        bytes += sizeof(level) + level.capacity() * sizeof(int);
+    }
+    return bytes;
+}
+
+// Function to print the MST tree (for debugging)
+void MSTTree::printMST() const
+{
+    mstGraph.printAdjacencyMatrix();
+}
+
+// Helper function to walk one tree component iteratively (no recursion, so deep paths cannot overflow the stack)
+void MSTTree::traverse(int source, std::vector<int> &visited, std::vector<long long> &dist, std::vector<int> &parent,
+                       std::vector<int> &order) const
+{
+    size_t next = order.size();
+    visited[source] = 1;
+    dist[source] = 0;
+    parent[source] = -1;
+    order.push_back(source);
+
+    // order doubles as the work list: vertices are expanded in the order they were reached
+    while (next < order.size())
+    {
+        int u = order[next++];
+        mstGraph.forEachNeighbor(u, [&](int v, int weight)
+                                 {
+            if (!visited[v])
+            {
+                visited[v] = 1;
+                dist[v] = dist[u] + weight;
+                parent[v] = u;
+                order.push_back(v);
+            } });
+    }
+}
+
+// Helper function to build the LCA index: one iterative DFS per component records the Euler tour
+// (every vertex is written when entered and again after each child returns), then a sparse table over
+// the tour answers "shallowest vertex in a range" in O(1). O(n log n) time and memory, done once per cache
+void MSTTree::buildLcaIndex() const
+{
+    int n = mstGraph.getNumberOfVertices();
+    component.assign(n, -1);
+    depth.assign(n, 0);
+    rootDistance.assign(n, 0);
+    firstVisit.assign(n, 0);
+
+    std::vector<int> tour;
+    tour.reserve(n > 0 ? 2 * n - 1 : 0);
+    std::vector<size_t> nextNeighbor(n, 0); // Next edge to explore for each vertex on the DFS stack
+    std::vector<int> stack;
+
+    for (int root = 0; root < n; ++root)
+    {
+        if (component[root] != -1)
+        {
+            continue; // Already part of an earlier component
+        }
+
+        component[root] = root;
+        firstVisit[root] = static_cast<int>(tour.size());
+        tour.push_back(root);
+        stack.push_back(root);
+
+        while (!stack.empty())
+        {
+            int u = stack.back();
+            RowView<Graph::Neighbor> adjacent = mstGraph.neighbors(u); // mstGraph always uses SPARSE storage
+            if (nextNeighbor[u] < adjacent.size())
             {
-                if (dist[i][k] != std::numeric_limits<int>::max() && dist[k][j] != std::numeric_limits<int>::max())
+                const Graph::Neighbor &next = adjacent[nextNeighbor[u]++];
+                int v = next.vertex;
+                if (component[v] != -1)
                 {
-                    dist[i][j] = std::min(dist[i][j], dist[i][k] + dist[k][j]);
+                    continue; // The edge back to the parent
                 }
+                component[v] = root;
+                depth[v] = depth[u] + 1;
+                rootDistance[v] = rootDistance[u] + next.weight;
+                firstVisit[v] = static_cast<int>(tour.size());
+                tour.push_back(v);
+                stack.push_back(v);
             }
+            else
+            {
+                stack.pop_back();
+                if (!stack.empty())
+                {
+                    tour.push_back(stack.back()); // Back in the parent after finishing u
+                }
+            }
+        }
+    }
+
+    // Level 0 is the tour itself, level k combines two overlapping halves of level k - 1
+    lcaTable.clear();
+    lcaTable.push_back(std::move(tour));
+    for (size_t span = 2; span <= lcaTable[0].size(); span *= 2)
+    {
+        const std::vector<int> &previous = lcaTable.back();
+        std::vector<int> level(lcaTable[0].size() - span + 1);
+        for (size_t i = 0; i < level.size(); ++i)
+        {
+            int left = previous[i];
+            int right = previous[i + span / 2];
+            level[i] = (depth[left] <= depth[right]) ? left : right;
         }
+        lcaTable.push_back(std::move(level));
     }
 
-    return dist;
+    lcaBuilt = true;
+}
+
+// Helper function to find the lowest common ancestor of two vertices of the same component in O(1).
+// Between the first visits of u and v the tour never leaves the subtree of their LCA, and passes through it
+int MSTTree::lowestCommonAncestor(int u, int v) const
+{
+    int left = std::min(firstVisit[u], firstVisit[v]);
+    int right = std::max(firstVisit[u], firstVisit[v]);
+    int level = 31 - __builtin_clz(static_cast<unsigned>(right - left + 1)); // floor(log2(range length))
+    int a = lcaTable[level][left];
+    int b = lcaTable[level][right - (1 << level) + 1];
+    return (depth[a] <= depth[b]) ? a : b;
 }
 
 // Function to return the edges in the MST
-std::vector<std::pair<int, int>> MSTTree::getEdges() const
+const std::vector<MSTTree::Edge> &MSTTree::getEdges() const
 {
     return edges;
 }
@@ -2,23 +2,116 @@
 #define MST_TREE_HPP
 
 #include "graph.hpp"
+#include "LinkCutTree.hpp"
 #include <vector>
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 class MSTTree
 {
+public:
+    // One edge of the MST, with its weight, so building and printing the tree never looks weights up again
+    struct Edge
+    {
+        int u;      // First endpoint
+        int v;      // Second endpoint
+        int weight; // Weight of the edge
+    };
+
+    // Summary of one tree of the MST; disconnected graphs give one per connected component (a spanning forest)
+    struct Component
+    {
+        int representative; // Smallest vertex of the component
+        int vertices;       // Number of vertices in the component
+        int weight;         // Total weight of the component's tree
+        int diameter;       // Longest distance inside the component's tree
+    };
+
 private:
     Graph mstGraph;                         // The graph that represents the MST
     int totalWeight;                        // The total weight of the MST
-    std::vector<std::pair<int, int>> edges; // Edges in the MST
+    std::vector<Edge> edges;                // Edges in the MST
+
+    // A mutex that copies as a new, unlocked one, so that MSTTree stays copyable
+    struct CacheMutex
+    {
+        std::mutex mutex;
+        CacheMutex() {}
+        CacheMutex(const CacheMutex &) {}
+        CacheMutex &operator=(const CacheMutex &) { return *this; }
+    };
+
+    // Memoized metrics: computed on first use, kept until invalidateCache(). Computed under cacheMutex, so
+    // several threads may query one MSTTree (a shared graph's) at the same time; changes need exclusive access
+    mutable CacheMutex cacheMutex;
+    mutable bool diameterCached;            // Whether diameter and diameterEnds are valid
+    mutable int diameter;                   // The longest distance in the MST
+    mutable std::pair<int, int> diameterEnds; // The two vertices at the ends of that longest path
+    mutable bool averageCached;             // Whether averageDistance is valid
+    mutable double averageDistance;         // The average distance between vertices of the MST
+    mutable bool componentsCached;          // Whether components is valid
+    mutable std::vector<Component> components; // One summary per tree, ordered by representative
+
+    // Lowest common ancestor index (Euler tour + sparse table), built by the first shortest-distance query
+    mutable bool lcaBuilt;                          // Whether the vectors below are valid
+    mutable std::vector<int> component;             // Root of the tree component each vertex belongs to
+    mutable std::vector<int> depth;                 // Number of edges between each vertex and its root
+    mutable std::vector<long long> rootDistance;    // Weighted distance between each vertex and its root
+    mutable std::vector<int> firstVisit;            // Position of each vertex's first appearance in the Euler tour
+    mutable std::vector<std::vector<int>> lcaTable; // lcaTable[k][i]: shallowest vertex of tour[i .. i + 2^k - 1]
+
+    // Dynamic mode: the MST (a minimum spanning forest once enabled) follows every change of the graph
+    struct TreeEdgeSlot
+    {
+        int node;        // Link-cut tree node standing for the edge
+        size_t position; // Index of the edge in edges
+    };
+    std::unique_ptr<LinkCutTree> linkCut;                      // Vertices plus one weighted node per tree edge, null until enabled
+    std::unordered_map<long long, TreeEdgeSlot> treeEdgeSlots; // Tree edges, keyed by edgeKey(u, v)
+    std::vector<std::pair<int, int>> nodeEnds;                 // Endpoints of the tree edge behind each link-cut node
+    std::vector<int> sideMark;                                 // Scratch marks of the replacement-edge search
+    int sideStamp;                                             // Mark value of the current search, so marks never need clearing
 
-    // Helper function to calculate all pairs shortest path (Floyd-Warshall)
-    std::vector<std::vector<int>> floydWarshall() const;
+    // Helper function to build the map key of the undirected edge (u, v)
+    static long long edgeKey(int u, int v);
+
+    // Helper functions to add or remove one edge of the tree, keeping every structure above in sync. With
+    // inGraph, the edge is already in mstGraph and only the dynamic-mode structures get it
+    void linkTreeEdge(int u, int v, int weight, bool inGraph = false);
+    void cutTreeEdge(int u, int v);
+
+    // Helper function to reconnect the two trees of u and v after the tree edge (u, v) was cut,
+    // through the lightest edge of graph between them (if there is one)
+    void reconnect(const Graph &graph, int u, int v);
+
+    // Helper function to walk the tree component containing source, filling the distance from source
+    // and the parent of every reached vertex, and setting visited to 1 for it. Reached vertices are appended to
+    // order in visiting order, so every vertex comes after its parent. visited must hold 0 for all vertices of
+    // that component (dist cannot mark them: with negative weights any distance may occur)
+    void traverse(int source, std::vector<int> &visited, std::vector<long long> &dist, std::vector<int> &parent,
+                  std::vector<int> &order) const;
+
+    // Helper function to build the LCA index over every component of the MST
+    void buildLcaIndex() const;
+
+    // Helper function to find the lowest common ancestor of two vertices of the same component in O(1)
+    int lowestCommonAncestor(int u, int v) const;
 
 public:
-    // Constructor to build the MST tree from a given graph and edges
-    MSTTree(const Graph &graph, const std::vector<std::pair<int, int>> &mstEdges);
+    // Constructor to build the MST tree on numVertices vertices from its weighted edges, in O(n + edges)
+    MSTTree(int numVertices, const std::vector<Edge> &mstEdges);
+
+    // Copy constructor, for a copy that is changed while the original stays in use. The memoized metrics are
+    // copied, the distance index is not (it is rebuilt by the copy's first shortest-distance query)
+    MSTTree(const MSTTree &other);
+
+    // Move constructor
+    MSTTree(MSTTree &&other) = default;
+
+    MSTTree &operator=(const MSTTree &) = delete;
 
     // Function to calculate the total weight of the MST
     int getTotalWeight() const;
@@ -26,16 +119,56 @@ public:
     // Function to find the longest distance between two vertices in the MST
     int getLongestDistance() const;
 
+    // Function to get the two vertices at the ends of the longest path in the MST
+    std::pair<int, int> getDiameterEndpoints() const;
+
+    // Function to get one summary per tree of the MST (isolated vertices included), ordered by representative
+    const std::vector<Component> &getComponents() const;
+
+    // Function to fill the component cache with summaries that were already computed elsewhere
+    // (SpanningForest solves every component on its own, so it gets them for free)
+    void setComponents(std::vector<Component> summaries);
+
     // Function to calculate the average distance between any two vertices in the graph
     double getAverageDistance() const;
 
     // Function to find the shortest distance between two vertices in the MST
     int getShortestDistance(int u, int v) const;
 
+    // Function to answer a batch of shortest-distance queries: distances[i] gets the distance between the
+    // vertices of pairs[i], or -1 where getShortestDistance() fails (silently, unlike it). The distance index is
+    // built first; the queries then only read it, so numThreads threads answer disjoint parts of a large batch
+    void getShortestDistances(const std::vector<std::pair<int, int>> &pairs, std::vector<long long> &distances,
+                              int numThreads) const;
+
+    // Functions to tell whether the next query will be answered from the cache
+    bool isLongestDistanceCached() const;
+    bool isAverageDistanceCached() const;
+    bool isComponentsCached() const;
+    bool isDistanceIndexBuilt() const;
+
+    // Function to drop every memoized metric and index, they are recomputed on the next query
+    void invalidateCache();
+
+    // Function to switch on dynamic mode. graph must be the graph this MST was computed from, in its current
+    // state; components the MST does not reach yet are spanned too, so from now on it is a minimum spanning forest
+    void enableDynamicMode(const Graph &graph);
+
+    // Function to check whether dynamic mode is on
+    bool isDynamic() const;
+
+    // Function to update the MST after the edge (u, v) of graph was added, removed or re-weighted. graph must
+    // already contain the change. Returns true if the MST changed (its memoized metrics are then dropped)
+    bool onEdgeChanged(const Graph &graph, int u, int v);
+
+    // Function to estimate the memory the MST takes, in bytes, including the metrics and index built so far
+    size_t getMemoryUsage() const;
+
     // Function to print the MST tree for debugging
     void printMST() const;
 
-    std::vector<std::pair<int, int>> getEdges() const; 
+    // Function to return the edges in the MST, with their weights (by reference, no copy)
+    const std::vector<Edge> &getEdges() const;
 };
 
 #endif
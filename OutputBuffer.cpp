@@ -0,0 +1,240 @@
+#include "OutputBuffer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// Chunks handed to one sendmsg() call
+const int MAX_IOVECS = 64;
+
+// Free chunks a thread keeps for later replies; the others are freed
+const size_t MAX_POOLED_CHUNKS = 64;
+
+// Free chunks of one thread. A chunk goes back to the pool of the thread that sent it, which need not be the
+// one that took it
+struct OutputBuffer::ChunkPool
+{
+    std::vector<Chunk *> free;
+
+    ~ChunkPool()
+    {
+        for (Chunk *chunk : free)
+        {
+            delete chunk;
+        }
+    }
+};
+
+OutputBuffer::OutputBuffer(int fd) : fd(fd), pending(0), flushAt(HIGH_WATER_MARK), failed(false)
+{
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    for (Chunk *chunk : chunks)
+    {
+        releaseChunk(chunk);
+    }
+}
+
+OutputBuffer &OutputBuffer::operator<<(const char *text)
+{
+    append(text, std::strlen(text));
+    return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(const std::string &text)
+{
+    append(text.data(), text.size());
+    return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(char c)
+{
+    append(&c, 1);
+    return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(int value)
+{
+    return *this << static_cast<long long>(value);
+}
+
+OutputBuffer &OutputBuffer::operator<<(long long value)
+{
+    bool negative = value < 0;
+    appendInteger(negative, negative ? 0 - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value));
+    return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(size_t value)
+{
+    appendInteger(false, value);
+    return *this;
+}
+
+OutputBuffer &OutputBuffer::operator<<(double value)
+{
+    char text[512]; // "%f" of the largest double has 316 characters
+    int length = std::snprintf(text, sizeof(text), "%f", value); // The format of std::to_string(double)
+    append(text, static_cast<size_t>(std::max(length, 0)));
+    return *this;
+}
+
+// Helper function to print an integer without a temporary string: the digits are written backwards into a
+// small array and appended from there
+void OutputBuffer::appendInteger(bool negative, unsigned long long magnitude)
+{
+    char digits[24];
+    char *first = digits + sizeof(digits);
+    do
+    {
+        *--first = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative)
+    {
+        *--first = '-';
+    }
+    append(first, static_cast<size_t>(digits + sizeof(digits) - first));
+}
+
+// Function to append bytes, filling the last chunk and taking new ones as needed
+void OutputBuffer::append(const char *data, size_t length)
+{
+    if (failed)
+    {
+        return;
+    }
+    while (length > 0)
+    {
+        if (chunks.empty() || chunks.back()->end == CHUNK_SIZE)
+        {
+            chunks.push_back(acquireChunk());
+        }
+        Chunk *chunk = chunks.back();
+        size_t count = std::min(length, CHUNK_SIZE - chunk->end);
+        std::memcpy(chunk->data + chunk->end, data, count);
+        chunk->end += count;
+        pending += count;
+        data += count;
+        length -= count;
+    }
+    if (pending >= flushAt)
+    {
+        flush(); // Stream long replies while the socket takes them, without a system call per append
+    }
+}
+
+// Function to send the waiting chunks, several per system call, until they are gone or the socket is full
+bool OutputBuffer::flush()
+{
+    while (pending > 0 && !failed)
+    {
+        iovec parts[MAX_IOVECS];
+        int count = 0;
+        for (size_t i = 0; i < chunks.size() && count < MAX_IOVECS; ++i)
+        {
+            parts[count].iov_base = chunks[i]->data + chunks[i]->begin;
+            parts[count].iov_len = chunks[i]->end - chunks[i]->begin;
+            ++count;
+        }
+        msghdr message = {};
+        message.msg_iov = parts;
+        message.msg_iovlen = count;
+
+        ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            // Give back the chunks that went out completely; the first one left may have gone out in part
+            pending -= sent;
+            size_t done = 0;
+            size_t remaining = static_cast<size_t>(sent);
+            while (done < chunks.size() && remaining >= chunks[done]->end - chunks[done]->begin)
+            {
+                remaining -= chunks[done]->end - chunks[done]->begin;
+                releaseChunk(chunks[done]);
+                ++done;
+            }
+            chunks.erase(chunks.begin(), chunks.begin() + done);
+            if (remaining > 0)
+            {
+                chunks.front()->begin += remaining;
+            }
+            continue;
+        }
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break; // The rest waits for the client to read
+        }
+
+        // The client is gone
+        for (Chunk *chunk : chunks)
+        {
+            releaseChunk(chunk);
+        }
+        chunks.clear();
+        pending = 0;
+        failed = true;
+    }
+    flushAt = pending + HIGH_WATER_MARK;
+    return !failed;
+}
+
+// Function to check whether a flush failed
+bool OutputBuffer::hasFailed() const
+{
+    return failed;
+}
+
+// Function to get the number of bytes waiting to be sent
+size_t OutputBuffer::pendingBytes() const
+{
+    return pending;
+}
+
+// Helper function to get the calling thread's pool
+OutputBuffer::ChunkPool &OutputBuffer::threadPool()
+{
+    static thread_local ChunkPool pool;
+    return pool;
+}
+
+// Helper function to take an empty chunk, from the calling thread's pool if it has one
+OutputBuffer::Chunk *OutputBuffer::acquireChunk()
+{
+    ChunkPool &pool = threadPool();
+    Chunk *chunk;
+    if (pool.free.empty())
+    {
+        chunk = new Chunk;
+    }
+    else
+    {
+        chunk = pool.free.back();
+        pool.free.pop_back();
+    }
+    chunk->begin = 0;
+    chunk->end = 0;
+    return chunk;
+}
+
+// Helper function to give a chunk back to the calling thread's pool, or free it when the pool is full
+void OutputBuffer::releaseChunk(Chunk *chunk)
+{
+    ChunkPool &pool = threadPool();
+    if (pool.free.size() < MAX_POOLED_CHUNKS)
+    {
+        pool.free.push_back(chunk);
+    }
+    else
+    {
+        delete chunk;
+    }
+}
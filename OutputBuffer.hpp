@@ -0,0 +1,81 @@
+#ifndef OUTPUTBUFFER_HPP
+#define OUTPUTBUFFER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Buffered writer of a client's replies. Replies are formatted straight into fixed-size chunks (numbers
+// included, without temporary strings) and the chunks are sent together with one sendmsg() (a writev() that
+// cannot raise SIGPIPE). Chunks come from a per-thread pool and go back to it once sent, so a connection that
+// keeps answering does not allocate.
+//
+// Nothing is sent until flush() is called or HIGH_WATER_MARK more bytes are waiting. A long reply, such as the edge
+// list of a large MST, therefore streams out while it is being formatted. flush() never waits: whatever the
+// socket does not take stays in the buffer, and the Connection stops running commands until its event loop
+// reports the socket writable again. Only the thread running the connection's commands may use the buffer
+class OutputBuffer
+{
+public:
+    static const size_t CHUNK_SIZE = 16 * 1024;       // Bytes per chunk
+    static const size_t HIGH_WATER_MARK = 256 * 1024; // Bytes appended since the last flush that make an append flush
+
+    // Constructor for replies to the (non-blocking) socket fd, which the buffer does not own
+    explicit OutputBuffer(int fd);
+
+    // Destructor; unsent data is dropped and the chunks return to the pool
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    // Functions to append text or a number (printed like std::to_string does)
+    OutputBuffer &operator<<(const char *text);
+    OutputBuffer &operator<<(const std::string &text);
+    OutputBuffer &operator<<(char c);
+    OutputBuffer &operator<<(int value);
+    OutputBuffer &operator<<(long long value);
+    OutputBuffer &operator<<(size_t value);
+    OutputBuffer &operator<<(double value);
+
+    // Function to append length bytes
+    void append(const char *data, size_t length);
+
+    // Function to send as much of the waiting data as the socket takes without blocking. Returns false if the
+    // socket failed; the buffer is then failed: it drops its data and ignores whatever is appended later
+    bool flush();
+
+    // Function to check whether a flush failed
+    bool hasFailed() const;
+
+    // Function to get the number of bytes waiting to be sent
+    size_t pendingBytes() const;
+
+private:
+    struct Chunk
+    {
+        size_t begin;           // First byte not sent yet
+        size_t end;             // One past the last byte written
+        char data[CHUNK_SIZE];  // The bytes
+    };
+
+    int fd;                    // The socket
+    std::vector<Chunk *> chunks; // Chunks waiting to be sent, in order
+    size_t pending;            // Bytes waiting in chunks
+    size_t flushAt;            // Value of pending at which append() flushes: HIGH_WATER_MARK past the last flush
+    bool failed;               // Set when a flush fails
+
+    struct ChunkPool; // Free chunks of one thread
+
+    // Helper function to get the calling thread's pool
+    static ChunkPool &threadPool();
+
+    // Helper functions to take a chunk from the calling thread's pool and to give one back
+    static Chunk *acquireChunk();
+    static void releaseChunk(Chunk *chunk);
+
+    // Helper function to append an integer given as sign and magnitude
+    void appendInteger(bool negative, unsigned long long magnitude);
+};
+
+#endif // OUTPUTBUFFER_HPP
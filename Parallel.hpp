@@ -0,0 +1,195 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include "Activeobject.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Smallest number of items worth handing to a thread of its own
+const size_t PARALLEL_MIN_CHUNK = 2048;
+
+// Returns the number of threads to use when the caller did not ask for a specific count
+inline int defaultThreadCount()
+{
+    unsigned int cores = std::thread::hardware_concurrency();
+    return (cores == 0) ? 1 : static_cast<int>(cores);
+}
+
+/**
+ * @brief Gets the pool parallelFor() hands its chunks to.
+ *
+ * Null by default: every call then starts threads of its own. The server sets it to its work-stealing compute
+ * pool before it starts serving, so all parallel loops share that pool's threads, and a loop inside one of the
+ * pool's tasks (a component of "solve forest" solved with Borůvka, say) is run by the idle workers instead of
+ * oversubscribing the cores.
+ */
+inline ActiveObject *&parallelPool()
+{
+    static ActiveObject *pool = nullptr;
+    return pool;
+}
+
+/**
+ * @brief Splits the range [0, count) into contiguous chunks and runs body(begin, end, chunk) on each.
+ *
+ * Chunk 0 runs on the calling thread, the others as tasks of parallelPool(), or on up to numThreads - 1
+ * extra threads if there is no pool. Ranges shorter than
+ * two minChunk are not split at all, so callers can use this unconditionally. Returns once every chunk has
+ * finished. The split only depends on numThreads, count and minChunk, so two calls with the same arguments
+ * hand the same chunks to the same chunk numbers.
+ */
+template <typename Body>
+void parallelFor(int numThreads, size_t count, Body body, size_t minChunk = PARALLEL_MIN_CHUNK)
+{
+    size_t chunks = std::min(static_cast<size_t>(std::max(numThreads, 1)), count / minChunk);
+    if (chunks <= 1)
+    {
+        body(static_cast<size_t>(0), count, 0);
+        return;
+    }
+
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    ActiveObject *pool = parallelPool();
+    if (pool)
+    {
+        std::atomic<int> pending(0);
+        for (size_t chunk = 1; chunk < chunks; ++chunk)
+        {
+            size_t begin = chunk * chunkSize;
+            size_t end = std::min(count, begin + chunkSize);
+            pool->spawn(pending, [=, &body]()
+                        { body(begin, end, static_cast<int>(chunk)); });
+        }
+        body(static_cast<size_t>(0), std::min(count, chunkSize), 0);
+        pool->waitFor(pending);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        size_t begin = chunk * chunkSize;
+        size_t end = std::min(count, begin + chunkSize);
+        threads.emplace_back([=, &body]()
+                             { body(begin, end, static_cast<int>(chunk)); });
+    }
+
+    body(static_cast<size_t>(0), std::min(count, chunkSize), 0);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Sorts [first, first + count) with numThreads threads.
+ *
+ * Every thread sorts one contiguous chunk, then neighbouring sorted chunks are merged pairwise, with all the
+ * merges of one round running in parallel.
+ */
+template <typename Iterator, typename Compare>
+void parallelSort(int numThreads, Iterator first, size_t count, Compare comp)
+{
+    size_t chunks = std::min(static_cast<size_t>(std::max(numThreads, 1)), count / PARALLEL_MIN_CHUNK);
+    if (chunks <= 1)
+    {
+        std::sort(first, first + count, comp);
+        return;
+    }
+
+    std::vector<size_t> bounds(chunks + 1);
+    for (size_t chunk = 0; chunk <= chunks; ++chunk)
+    {
+        bounds[chunk] = count * chunk / chunks;
+    }
+
+    parallelFor(numThreads, chunks, [&](size_t begin, size_t end, int)
+                {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            std::sort(first + bounds[chunk], first + bounds[chunk + 1], comp);
+        } }, 1);
+
+    for (size_t width = 1; width < chunks; width *= 2)
+    {
+        size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+        parallelFor(numThreads, pairs, [&](size_t begin, size_t end, int)
+                    {
+            for (size_t pair = begin; pair < end; ++pair)
+            {
+                size_t low = 2 * pair * width;
+                size_t middle = std::min(low + width, chunks);
+                size_t high = std::min(low + 2 * width, chunks);
+                std::inplace_merge(first + bounds[low], first + bounds[middle], first + bounds[high], comp);
+            } }, 1);
+    }
+}
+
+/**
+ * @brief Stable parallel partition of items[begin, end): elements for which pred holds come first.
+ *
+ * pred is evaluated exactly once per element. Each chunk counts its matches, a prefix sum gives every chunk its
+ * output offsets, and the chunks then scatter into scratch and copy back in parallel.
+ *
+ * @return The index of the first element for which pred does not hold.
+ */
+template <typename T, typename Predicate>
+size_t parallelPartition(int numThreads, std::vector<T> &items, size_t begin, size_t end, Predicate pred,
+                         std::vector<T> &scratch)
+{
+    size_t count = end - begin;
+    size_t chunks = std::max(static_cast<size_t>(1), std::min(static_cast<size_t>(std::max(numThreads, 1)), count / PARALLEL_MIN_CHUNK));
+    std::vector<char> matches(count);
+    std::vector<size_t> matchCount(chunks, 0);
+
+    parallelFor(numThreads, count, [&](size_t first, size_t last, int chunk)
+                {
+        size_t found = 0;
+        for (size_t i = first; i < last; ++i)
+        {
+            matches[i] = pred(items[begin + i]) ? 1 : 0;
+            found += matches[i];
+        }
+        matchCount[chunk] = found; });
+
+    // Chunk c writes its matches after those of chunks 0..c-1, and its other elements after all matches
+    // plus the other elements of chunks 0..c-1
+    size_t totalMatches = 0;
+    for (size_t found : matchCount)
+    {
+        totalMatches += found;
+    }
+    std::vector<size_t> matchOffset(chunks), restOffset(chunks);
+    size_t matchesBefore = 0;
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        size_t elementsBefore = std::min(count, chunk * chunkSize);
+        matchOffset[chunk] = matchesBefore;
+        restOffset[chunk] = totalMatches + (elementsBefore - matchesBefore);
+        matchesBefore += matchCount[chunk];
+    }
+
+    if (scratch.size() < end)
+    {
+        scratch.resize(end);
+    }
+    parallelFor(numThreads, count, [&](size_t first, size_t last, int chunk)
+                {
+        size_t nextMatch = begin + matchOffset[chunk];
+        size_t nextRest = begin + restOffset[chunk];
+        for (size_t i = first; i < last; ++i)
+        {
+            scratch[matches[i] ? nextMatch++ : nextRest++] = items[begin + i];
+        } });
+    parallelFor(numThreads, count, [&](size_t first, size_t last, int)
+                { std::copy(scratch.begin() + begin + first, scratch.begin() + begin + last, items.begin() + begin + first); });
+
+    return begin + totalMatches;
+}
+
+#endif // PARALLEL_HPP
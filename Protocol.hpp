@@ -0,0 +1,267 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// One word of a command: a view into the request, nothing is copied
+struct Token
+{
+    const char *data; // First character of the word
+    size_t length;    // Number of characters
+
+    // Function to compare the word with a string literal (its length is known at compile time)
+    template <size_t N>
+    bool is(const char (&word)[N]) const
+    {
+        return length == N - 1 && std::memcmp(data, word, N - 1) == 0;
+    }
+
+    // Function to copy the word, for replies that quote it
+    std::string str() const
+    {
+        return std::string(data, length);
+    }
+};
+
+// Splits a command into words separated by spaces, tabs or '\r', in place and without allocating
+class Tokenizer
+{
+public:
+    // Constructor over the characters [data, data + length)
+    Tokenizer(const char *data, size_t length) : position(data), end(data + length) {}
+
+    // Function to get the next word; returns false at the end of the command
+    bool next(Token &token)
+    {
+        skipSpaces();
+        if (position == end)
+        {
+            return false;
+        }
+        const char *start = position;
+        while (position != end && !isSpace(*position))
+        {
+            ++position;
+        }
+        token = {start, static_cast<size_t>(position - start)};
+        return true;
+    }
+
+    // Function to read the next word as a decimal integer (optionally signed) in [min, max]. Returns false and
+    // leaves value unchanged if there is no next word or it is not such a number; the word is consumed anyway
+    bool nextNumber(long long &value, long long min = LLONG_MIN, long long max = LLONG_MAX)
+    {
+        Token token;
+        if (!next(token))
+        {
+            return false;
+        }
+        const char *digit = token.data;
+        const char *last = token.data + token.length;
+        bool negative = (*digit == '-');
+        if (negative || *digit == '+')
+        {
+            ++digit;
+        }
+        if (digit == last)
+        {
+            return false;
+        }
+        unsigned long long magnitude = 0;
+        for (; digit != last; ++digit)
+        {
+            unsigned digitValue = static_cast<unsigned>(*digit - '0');
+            if (digitValue > 9 || magnitude > (ULLONG_MAX - digitValue) / 10)
+            {
+                return false;
+            }
+            magnitude = magnitude * 10 + digitValue;
+        }
+        if (magnitude > static_cast<unsigned long long>(LLONG_MAX) + (negative ? 1 : 0))
+        {
+            return false;
+        }
+        long long number = negative ? static_cast<long long>(0 - magnitude) : static_cast<long long>(magnitude);
+        if (number < min || number > max)
+        {
+            return false;
+        }
+        value = number;
+        return true;
+    }
+
+    // Same as nextNumber(), for an int
+    bool nextInt(int &value)
+    {
+        long long number;
+        if (!nextNumber(number, INT_MIN, INT_MAX))
+        {
+            return false;
+        }
+        value = static_cast<int>(number);
+        return true;
+    }
+
+    // Function to check whether only spaces are left
+    bool atEnd()
+    {
+        skipSpaces();
+        return position == end;
+    }
+
+private:
+    const char *position; // Next character to look at
+    const char *end;      // One past the last character
+
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    void skipSpaces()
+    {
+        while (position != end && isSpace(*position))
+        {
+            ++position;
+        }
+    }
+};
+
+// The commands of the protocol, in the order of the server's dispatch table
+enum CommandId
+{
+    CMD_CREATE,
+    CMD_USE,
+    CMD_ADD,
+    CMD_REMOVE,
+    CMD_UPLOAD,
+    CMD_SOLVE,
+    CMD_LONGEST_DISTANCE,
+    CMD_AVG_DISTANCE,
+    CMD_SHORTEST_DISTANCE,
+    CMD_BATCH,
+    CMD_DISTANCES,
+    CMD_COMPONENTS,
+    CMD_WORKSPACE,
+    CMD_CACHE,
+    CMD_STATUS,
+    CMD_WAIT,
+    CMD_CANCEL,
+    CMD_SHUTDOWN,
+    CMD_UNKNOWN, // Not a command; also the number of commands
+};
+
+/**
+ * @brief Reads the command name from the front of a request and identifies it.
+ *
+ * The name is matched exactly, by a switch on its length followed by a few comparisons. Two-word
+ * names ("longest distance", ...) consume their second word too, so afterwards args is at the first
+ * argument.
+ */
+inline CommandId parseCommand(Tokenizer &args)
+{
+    Token name;
+    if (!args.next(name))
+    {
+        return CMD_UNKNOWN;
+    }
+
+    Token second;
+    switch (name.length)
+    {
+    case 3:
+        if (name.is("use"))
+        {
+            return CMD_USE;
+        }
+        if (name.is("add"))
+        {
+            return CMD_ADD;
+        }
+        if (name.is("avg"))
+        {
+            return (args.next(second) && second.is("distance")) ? CMD_AVG_DISTANCE : CMD_UNKNOWN;
+        }
+        break;
+    case 4:
+        if (name.is("wait"))
+        {
+            return CMD_WAIT;
+        }
+        break;
+    case 5:
+        if (name.is("solve"))
+        {
+            return CMD_SOLVE;
+        }
+        if (name.is("batch"))
+        {
+            return CMD_BATCH;
+        }
+        if (name.is("cache"))
+        {
+            return CMD_CACHE;
+        }
+        break;
+    case 6:
+        if (name.is("create"))
+        {
+            return CMD_CREATE;
+        }
+        if (name.is("remove"))
+        {
+            return CMD_REMOVE;
+        }
+        if (name.is("upload"))
+        {
+            return CMD_UPLOAD;
+        }
+        if (name.is("status"))
+        {
+            return CMD_STATUS;
+        }
+        if (name.is("cancel"))
+        {
+            return CMD_CANCEL;
+        }
+        break;
+    case 7:
+        if (name.is("longest"))
+        {
+            return (args.next(second) && second.is("distance")) ? CMD_LONGEST_DISTANCE : CMD_UNKNOWN;
+        }
+        break;
+    case 8:
+        if (name.is("shortest"))
+        {
+            return (args.next(second) && second.is("distance")) ? CMD_SHORTEST_DISTANCE : CMD_UNKNOWN;
+        }
+        if (name.is("shutdown"))
+        {
+            return CMD_SHUTDOWN;
+        }
+        break;
+    case 9:
+        if (name.is("workspace"))
+        {
+            return CMD_WORKSPACE;
+        }
+        if (name.is("distances"))
+        {
+            return CMD_DISTANCES;
+        }
+        break;
+    case 10:
+        if (name.is("components"))
+        {
+            return CMD_COMPONENTS;
+        }
+        break;
+    }
+    return CMD_UNKNOWN;
+}
+
+#endif // PROTOCOL_HPP
@@ -0,0 +1,222 @@
+#include "Reactor.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+// Events fetched per epoll_wait() call
+const int MAX_EVENTS = 256;
+
+// Events a client socket is watched for
+const uint32_t CLIENT_EVENTS = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+
+// Constructor to register the listening socket and the wake-up eventfd with a new epoll instance
+Reactor::Reactor(int listenFd, ActiveObject &workers, Connection::CommandHandler handler)
+    : listenFd(listenFd), epollFd(-1), wakeFd(-1), workers(workers), handler(std::move(handler)), running(true)
+{
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0)
+    {
+        perror("epoll"); // Print error if the event loop cannot be set up
+        exit(EXIT_FAILURE);
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+}
+
+Reactor::~Reactor()
+{
+    ::close(wakeFd);
+    ::close(epollFd);
+}
+
+// Function to run the event loop
+void Reactor::run()
+{
+    epoll_event events[MAX_EVENTS];
+    std::chrono::steady_clock::time_point nextTimerCheck = std::chrono::steady_clock::now();
+    while (running)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= nextTimerCheck)
+        {
+            checkTimers();
+            nextTimerCheck = now + std::chrono::milliseconds(TIMER_INTERVAL_MS);
+        }
+
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, TIMER_INTERVAL_MS);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd)
+            {
+                continue; // stop() was called, running is already false
+            }
+            if (fd == listenFd)
+            {
+                acceptClients();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it != connections.end())
+            {
+                onEvent(it->second, events[i].events);
+            }
+        }
+    }
+
+    // Disconnect every client; commands that are running notice it and the rest are dropped
+    for (auto &entry : connections)
+    {
+        entry.second->close();
+        entry.second->setWakeUp(nullptr); // Jobs may still try to wake it up
+        std::cout << "Closed client socket: " << entry.first << std::endl;
+    }
+    connections.clear();
+}
+
+// Function to make run() return
+void Reactor::stop()
+{
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0)
+    {
+        perror("eventfd write");
+    }
+}
+
+// Helper function to accept clients until none is pending (the listening socket is edge-triggered too)
+void Reactor::acceptClients()
+{
+    while (true)
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                perror("accept"); // E.g. out of descriptors: the remaining clients are accepted with the next one
+            }
+            return;
+        }
+
+        epoll_event event = {};
+        event.events = CLIENT_EVENTS;
+        event.data.fd = fd;
+        connections[fd] = std::make_shared<Connection>(fd);
+        connections[fd]->setWakeUp([this, fd]()
+                                   { wakeUp(fd); });
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        std::cout << "New client connection accepted.\n"; // Print message about new client
+    }
+}
+
+// Helper function to read from a client, queue its complete commands, and start a worker on them if none is
+// running yet; a writable socket resumes a suspended client. A client that closed its side still gets the
+// replies to the commands it sent before
+void Reactor::onEvent(const std::shared_ptr<Connection> &connection, uint32_t events)
+{
+    Connection::ReadResult result = connection->readAvailable();
+    if (result != Connection::FAILED && connection->queueCommands(result == Connection::PEER_CLOSED))
+    {
+        schedule(connection);
+    }
+    else if ((events & EPOLLOUT) && connection->resume())
+    {
+        schedule(connection);
+    }
+
+    if (connection->hasOverlongCommand())
+    {
+        std::cout << "Client sent an overlong command.\n";
+        connection->close();
+    }
+    if (result == Connection::FAILED || (events & EPOLLERR))
+    {
+        connection->close();
+    }
+
+    connection->parkReader(); // The registration stays; the wake-up hook re-checks it once reading resumes
+    if (connection->isDone())
+    {
+        removeConnection(connection->getFd());
+    }
+}
+
+// Helper function to run a client's commands on a worker
+void Reactor::schedule(const std::shared_ptr<Connection> &connection)
+{
+    std::shared_ptr<Connection> client = connection;
+    workers.enqueueTask([this, client]()
+                        { client->runCommands(handler); });
+}
+
+// Helper function to make the event loop look at a client again, e.g. after its reading paused or once it is
+// suspended. Modifying the registration re-checks the socket, so input that is already waiting, or room to
+// write, is reported as a new event
+void Reactor::wakeUp(int fd)
+{
+    epoll_event event = {};
+    event.events = CLIENT_EVENTS;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event); // Fails harmlessly if the client was removed meanwhile
+}
+
+// Helper function to check the timers of every client, dropping the ones that are done
+void Reactor::checkTimers()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::vector<int> done;
+    for (auto &entry : connections)
+    {
+        entry.second->checkTimers(now);
+        if (entry.second->isDone())
+        {
+            done.push_back(entry.first);
+        }
+    }
+    for (int fd : done)
+    {
+        removeConnection(fd);
+    }
+}
+
+// Helper function to stop watching a client
+void Reactor::removeConnection(int fd)
+{
+    connections[fd]->setWakeUp(nullptr); // Its running commands must not reach the reactor after it is gone
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    connections.erase(fd); // Running commands hold their own reference, the socket closes after them
+    std::cout << "Client disconnected.\n";
+}
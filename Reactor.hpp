@@ -0,0 +1,62 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include "Activeobject.hpp"
+#include "Connection.hpp"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+// Event loop of the server: one thread owns the listening socket and every client socket through a single
+// edge-triggered epoll instance. It accepts clients, reads whatever they send and hands complete commands to
+// the ActiveObject workers, so an idle client costs a socket and a Connection, not a thread. Clients are also
+// watched for EPOLLOUT, on which a connection suspended by a full socket goes back to the workers
+class Reactor
+{
+public:
+    // Constructor; listenFd must be a bound, listening socket (it is made non-blocking). Commands are run
+    // by handler on workers, whose tasks refer to the reactor: shut the workers down before destroying it
+    Reactor(int listenFd, ActiveObject &workers, Connection::CommandHandler handler);
+
+    // Destructor; closes the epoll instance (not the listening socket)
+    ~Reactor();
+
+    Reactor(const Reactor &) = delete;
+    Reactor &operator=(const Reactor &) = delete;
+
+    // Function to run the event loop on the calling thread until stop() is called; then every client is disconnected
+    void run();
+
+    // Function to make run() return. Safe to call from any thread
+    void stop();
+
+private:
+    int listenFd;                        // The listening socket
+    int epollFd;                         // The epoll instance watching every socket
+    int wakeFd;                          // eventfd that stop() writes to, to wake up epoll_wait()
+    ActiveObject &workers;               // Runs the commands
+    Connection::CommandHandler handler;  // Handles one command
+    std::atomic<bool> running;           // Cleared by stop()
+    std::unordered_map<int, std::shared_ptr<Connection>> connections; // Open clients by socket (reactor thread only)
+
+    // Helper function to accept every pending client
+    void acceptClients();
+
+    // Helper function to read from a client and dispatch its complete commands, or resume a suspended one
+    void onEvent(const std::shared_ptr<Connection> &connection, uint32_t events);
+
+    // Helper function to run a client's commands on a worker
+    void schedule(const std::shared_ptr<Connection> &connection);
+
+    // Helper function to make the event loop look at a client again. The connection's wake-up hook, so called
+    // from workers (and any other thread)
+    void wakeUp(int fd);
+
+    // Helper function to check the timers of every client
+    void checkTimers();
+
+    // Helper function to stop watching a client. It stays alive until its running commands finish
+    void removeConnection(int fd);
+};
+
+#endif // REACTOR_HPP
@@ -0,0 +1,242 @@
+#include "Simd.hpp"
+#include <limits>
+
+// The AVX2 kernels are built on any x86 compiler that can target AVX2 per function; unless the whole build
+// targets AVX2 (e.g. ARCH_FLAGS=-march=native), they only run when the CPU reports AVX2 at run time
+#if defined(__AVX2__)
+#define SIMD_HAS_AVX2 1
+#define SIMD_TARGET_AVX2
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_HAS_AVX2 1
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_HAS_AVX2 0
+#endif
+
+#if SIMD_HAS_AVX2 || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if SIMD_HAS_AVX2
+// Helper function to check once whether the AVX2 kernels may run
+static bool useAvx2()
+{
+#if defined(__AVX2__)
+    return true;
+#else
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#endif
+}
+#endif
+
+// Helper function to get the smallest of best and values[i .. count - 1]
+static int minimumFrom(const int *values, int i, int count, int best)
+{
+    for (; i < count; ++i)
+    {
+        best = (values[i] < best) ? values[i] : best;
+    }
+    return best;
+}
+
+// Helper function to get the first index from index on whose value is best, or -1
+static int findFrom(const int *values, int index, int count, int best)
+{
+    for (; index < count; ++index)
+    {
+        if (values[index] == best)
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+// Helper function to relax the edges of a dense adjacency row from vertex v on, one at a time
+static void relaxFrom(const int *row, const int *inTree, int *key, int *parent, int v, int count, int u)
+{
+    for (; v < count; ++v)
+    {
+        if (row[v] != 0 && inTree[v] == 0 && row[v] < key[v])
+        {
+            key[v] = row[v];
+            parent[v] = u;
+        }
+    }
+}
+
+#if SIMD_HAS_AVX2
+// Helper function for simdArgMin() with 8 lanes
+SIMD_TARGET_AVX2 static int argMinAvx2(const int *values, int count)
+{
+    int i = 0;
+    int best = std::numeric_limits<int>::max();
+    __m256i minimum = _mm256_set1_epi32(best);
+    for (; i + 8 <= count; i += 8)
+    {
+        minimum = _mm256_min_epi32(minimum, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), minimum);
+    for (int lane : lanes)
+    {
+        best = (lane < best) ? lane : best;
+    }
+    best = minimumFrom(values, i, count, best);
+
+    int index = 0;
+    __m256i target = _mm256_set1_epi32(best);
+    for (; index + 8 <= count; index += 8)
+    {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + index)), target);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        if (mask != 0)
+        {
+            return index + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+    return findFrom(values, index, count, best);
+}
+
+// Helper function for simdRelaxRow() with 8 lanes
+SIMD_TARGET_AVX2 static void relaxRowAvx2(const int *row, const int *inTree, int *key, int *parent, int count, int u)
+{
+    int v = 0;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i from = _mm256_set1_epi32(u);
+    for (; v + 8 <= count; v += 8)
+    {
+        __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + v));
+        __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key + v));
+        __m256i visited = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inTree + v));
+        __m256i better = _mm256_cmpgt_epi32(keys, weight);
+        __m256i update = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi32(weight, zero), visited), better);
+        if (_mm256_testz_si256(update, update))
+        {
+            continue; // Nothing to update in these 8 vertices
+        }
+        __m256i parents = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(parent + v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(key + v), _mm256_blendv_epi8(keys, weight, update));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(parent + v), _mm256_blendv_epi8(parents, from, update));
+    }
+    relaxFrom(row, inTree, key, parent, v, count, u);
+}
+#endif
+
+#if defined(__SSE2__)
+// Helper function for simdArgMin() with 4 lanes
+static int argMinSse2(const int *values, int count)
+{
+    int i = 0;
+    int best = std::numeric_limits<int>::max();
+    __m128i minimum = _mm_set1_epi32(best);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        __m128i smaller = _mm_cmplt_epi32(chunk, minimum); // SSE2 has no min_epi32, so blend by hand
+        minimum = _mm_or_si128(_mm_and_si128(smaller, chunk), _mm_andnot_si128(smaller, minimum));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), minimum);
+    for (int lane : lanes)
+    {
+        best = (lane < best) ? lane : best;
+    }
+    best = minimumFrom(values, i, count, best);
+
+    int index = 0;
+    __m128i target = _mm_set1_epi32(best);
+    for (; index + 4 <= count; index += 4)
+    {
+        __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + index)), target);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        if (mask != 0)
+        {
+            return index + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+    return findFrom(values, index, count, best);
+}
+
+// Helper function for simdRelaxRow() with 4 lanes
+static void relaxRowSse2(const int *row, const int *inTree, int *key, int *parent, int count, int u)
+{
+    int v = 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i from = _mm_set1_epi32(u);
+    for (; v + 4 <= count; v += 4)
+    {
+        __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + v));
+        __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + v));
+        __m128i visited = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inTree + v));
+        __m128i better = _mm_cmpgt_epi32(keys, weight);
+        __m128i update = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(weight, zero), visited), better);
+        if (_mm_movemask_epi8(update) == 0)
+        {
+            continue; // Nothing to update in these 4 vertices
+        }
+        __m128i parents = _mm_loadu_si128(reinterpret_cast<const __m128i *>(parent + v));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(key + v),
+                         _mm_or_si128(_mm_and_si128(update, weight), _mm_andnot_si128(update, keys)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(parent + v),
+                         _mm_or_si128(_mm_and_si128(update, from), _mm_andnot_si128(update, parents)));
+    }
+    relaxFrom(row, inTree, key, parent, v, count, u);
+}
+#endif
+
+// Function to find the index of the smallest value. One pass finds the minimum value with vector
+// min operations, a second pass finds where it first occurs
+int simdArgMin(const int *values, int count)
+{
+    if (count <= 0)
+    {
+        return -1;
+    }
+#if SIMD_HAS_AVX2
+    if (useAvx2())
+    {
+        return argMinAvx2(values, count);
+    }
+#endif
+#if defined(__SSE2__)
+    return argMinSse2(values, count);
+#else
+    return findFrom(values, 0, count, minimumFrom(values, 0, count, std::numeric_limits<int>::max()));
+#endif
+}
+
+// Function to relax every edge of a dense adjacency row. The three conditions become lane masks,
+// and key and parent are blended under their conjunction, so the loop has no branches
+void simdRelaxRow(const int *row, const int *inTree, int *key, int *parent, int count, int u)
+{
+#if SIMD_HAS_AVX2
+    if (useAvx2())
+    {
+        relaxRowAvx2(row, inTree, key, parent, count, u);
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    relaxRowSse2(row, inTree, key, parent, count, u);
+#else
+    relaxFrom(row, inTree, key, parent, 0, count, u);
+#endif
+}
+
+// Function to name the instruction set the kernels run with
+const char *simdInstructionSet()
+{
+#if SIMD_HAS_AVX2
+    if (useAvx2())
+    {
+        return "AVX2";
+    }
+#endif
+#if defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
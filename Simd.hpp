@@ -0,0 +1,17 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// Vectorized kernels of dense Prim. Each kernel has an AVX2, an SSE2 and a scalar version; the AVX2 one runs
+// when the CPU has AVX2, else the widest one the compiler targets (see ARCH_FLAGS in the Makefile)
+
+// Function to find the index of the smallest of values[0 .. count - 1] (the first one on ties), or -1 if count is 0
+int simdArgMin(const int *values, int count);
+
+// Function to relax every edge (u, v) of a dense adjacency row: wherever row[v] != 0, inTree[v] == 0 and
+// row[v] < key[v], sets key[v] = row[v] and parent[v] = u
+void simdRelaxRow(const int *row, const int *inTree, int *key, int *parent, int count, int u);
+
+// Function to name the instruction set the kernels run with ("AVX2", "SSE2" or "scalar")
+const char *simdInstructionSet();
+
+#endif // SIMD_HPP
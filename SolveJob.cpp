@@ -0,0 +1,91 @@
+#include "SolveJob.hpp"
+
+SolveJob::SolveJob()
+    : type(MSTFactory::PRIM), threads(0), automatic(false), forest(false), predictedMs(0), cached(false), kept(false),
+      actualMs(0), state(QUEUED), cancelRequested(false), queuedAt(std::chrono::steady_clock::now())
+{
+}
+
+// Function to move the job to RUNNING unless it was cancelled while queued
+bool SolveJob::start()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (state != QUEUED)
+    {
+        return false;
+    }
+    state = RUNNING;
+    return true;
+}
+
+// Function to move the job to DONE or CANCELLED and tell whoever waits for it
+void SolveJob::finish(bool completed)
+{
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        state = completed ? DONE : CANCELLED;
+        callback.swap(onDone);
+    }
+    if (callback)
+    {
+        callback();
+    }
+}
+
+// Function to stop the job; a queued one is cancelled right away, a running one by its algorithm
+void SolveJob::cancel()
+{
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (state == DONE || state == CANCELLED)
+        {
+            return;
+        }
+        cancelRequested = true;
+        if (state != QUEUED)
+        {
+            return; // finish() reports it once the algorithm has stopped
+        }
+        state = CANCELLED;
+        callback.swap(onDone);
+    }
+    if (callback)
+    {
+        callback();
+    }
+}
+
+// Function to get the flag cancel() sets
+const std::atomic<bool> *SolveJob::getCancelFlag() const
+{
+    return &cancelRequested;
+}
+
+// Function to get the job's progress
+SolveJob::State SolveJob::getState() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return state;
+}
+
+// Function to call callback once the job is DONE or CANCELLED
+void SolveJob::whenDone(std::function<void()> callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (state != DONE && state != CANCELLED)
+        {
+            onDone = std::move(callback);
+            return;
+        }
+    }
+    callback();
+}
+
+// Function to get the milliseconds since the job was queued
+double SolveJob::getAgeMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queuedAt).count();
+}
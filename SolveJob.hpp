@@ -0,0 +1,82 @@
+#ifndef SOLVEJOB_HPP
+#define SOLVEJOB_HPP
+
+#include "GraphRegistry.hpp"
+#include "MST_algo.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// One "solve": the algorithm chosen for a version of a graph and, once computed, its MST. A plain "solve"
+// runs its job inline; "solve async" hands it to the job pool and the client follows it by its id.
+//
+// The request fields are filled in before the job is started and the result fields by the thread that runs
+// it; other threads read the result only after getState() has returned DONE (or whenDone() has called back)
+struct SolveJob
+{
+    // Progress of a job
+    enum State
+    {
+        QUEUED,   // Waiting for a pool thread
+        RUNNING,  // Being computed
+        DONE,     // Computed (the result fields are set)
+        CANCELLED // Stopped by cancel() before it was done
+    };
+
+    // The request
+    std::unique_ptr<MSTAlgo> algo;                 // The algorithm, null if the one requested is unknown
+    MSTFactory::AlgorithmType type;                // Its type (of every component for a forest)
+    int threads;                                   // Thread count requested, 0 for the default
+    bool automatic;                                // Whether the cost model picked the algorithm
+    bool forest;                                   // Whether the components are solved separately
+    double predictedMs;                            // The cost model's prediction, for automatic ones
+    std::shared_ptr<GraphHandle> graph;            // Where the MST is published
+    std::shared_ptr<const GraphVersion> version;   // The version of the graph being solved
+
+    // The result
+    std::shared_ptr<MSTTree> mst; // The MST of version->graph
+    bool cached;                  // Whether it came from the cache of solved MSTs
+    bool kept;                    // Whether it was published, i.e. the graph did not change meanwhile
+    double actualMs;              // Time taken to compute it (or to find it in the cache)
+
+    // Constructor of a queued job with an empty request
+    SolveJob();
+
+    SolveJob(const SolveJob &) = delete;
+    SolveJob &operator=(const SolveJob &) = delete;
+
+    // Function for the thread that runs the job: moves it to RUNNING, or returns false if it was cancelled first
+    bool start();
+
+    // Function for the thread that runs the job: moves it to DONE if completed (the result is set), else to
+    // CANCELLED (the algorithm stopped early). Calls the whenDone() callback
+    void finish(bool completed);
+
+    // Function to stop the job: a queued job never runs, a running one stops at its algorithm's next
+    // cancellation point. Does nothing to a job that is already done
+    void cancel();
+
+    // Function to get the flag cancel() sets, for MSTAlgo::setCancelFlag()
+    const std::atomic<bool> *getCancelFlag() const;
+
+    // Function to get the job's progress
+    State getState() const;
+
+    // Function to have callback called once the job is DONE or CANCELLED: right away if it is already, else
+    // by the thread that finishes or cancels it. A job has one callback; a later one replaces it
+    void whenDone(std::function<void()> callback);
+
+    // Function to get the milliseconds since the job was queued
+    double getAgeMs() const;
+
+private:
+    mutable std::mutex mtx;                 // Guards state and onDone
+    State state;                            // Progress
+    std::function<void()> onDone;           // Set by whenDone(), called once the job is DONE or CANCELLED
+    std::atomic<bool> cancelRequested;      // Set by cancel(), read by the algorithm
+    std::chrono::steady_clock::time_point queuedAt; // When the job was created
+};
+
+#endif // SOLVEJOB_HPP
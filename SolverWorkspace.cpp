@@ -0,0 +1,124 @@
+#include "SolverWorkspace.hpp"
+
+std::atomic<long long> SolverWorkspace::totalAllocations(0);
+std::atomic<long long> SolverWorkspace::totalRuns(0);
+
+SolverWorkspace::SolverWorkspace() : heapCapacity(0), allocations(0), runs(0)
+{
+}
+
+// Function to get the calling thread's workspace, created on first use
+SolverWorkspace &SolverWorkspace::local()
+{
+    static thread_local SolverWorkspace workspace;
+    return workspace;
+}
+
+// Function to count one solver run on this workspace
+void SolverWorkspace::beginRun()
+{
+    runs++;
+    totalRuns++;
+}
+
+// Helper function to reserve room for count elements, counting the allocation if the buffer has to grow
+template <typename T>
+void SolverWorkspace::reserveCounted(std::vector<T> &buffer, size_t count)
+{
+    if (count > buffer.capacity())
+    {
+        buffer.reserve(count);
+        allocations++;
+        totalAllocations++;
+    }
+}
+
+// Function to borrow an int buffer holding size copies of value
+std::vector<int> &SolverWorkspace::ints(int slot, size_t size, int value)
+{
+    std::vector<int> &buffer = intBuffers[slot];
+    reserveCounted(buffer, size);
+    buffer.assign(size, value);
+    return buffer;
+}
+
+// Function to borrow an empty int buffer with room for capacity values
+std::vector<int> &SolverWorkspace::emptyInts(int slot, size_t capacity)
+{
+    std::vector<int> &buffer = intBuffers[slot];
+    buffer.clear();
+    reserveCounted(buffer, capacity);
+    return buffer;
+}
+
+// Function to borrow a long long buffer holding size copies of value
+std::vector<long long> &SolverWorkspace::longs(int slot, size_t size, long long value)
+{
+    std::vector<long long> &buffer = longBuffers[slot];
+    reserveCounted(buffer, size);
+    buffer.assign(size, value);
+    return buffer;
+}
+
+// Function to borrow the edge buffer empty, with room for capacity edges
+EdgeList &SolverWorkspace::edges(size_t capacity)
+{
+    edgeBuffer.clear();
+    reserveCounted(edgeBuffer.weights, capacity);
+    reserveCounted(edgeBuffer.from, capacity);
+    reserveCounted(edgeBuffer.to, capacity);
+    return edgeBuffer;
+}
+
+// Function to borrow the second edge buffer. The sort swaps the two buffers' arrays, so both of them end up
+// with room for capacity edges
+EdgeList &SolverWorkspace::sortScratch(size_t capacity)
+{
+    reserveCounted(scratchBuffer.weights, capacity);
+    reserveCounted(scratchBuffer.from, capacity);
+    reserveCounted(scratchBuffer.to, capacity);
+    return scratchBuffer;
+}
+
+// Function to borrow the buffer of MST edges empty, with room for capacity edges
+std::vector<MSTTree::Edge> &SolverWorkspace::treeEdges(size_t capacity)
+{
+    treeEdgeBuffer.clear();
+    reserveCounted(treeEdgeBuffer, capacity);
+    return treeEdgeBuffer;
+}
+
+// Function to borrow the heap. Its three arrays only grow when capacity is a new maximum
+IndexedHeap &SolverWorkspace::heap(int capacity)
+{
+    if (capacity > heapCapacity)
+    {
+        heapCapacity = capacity;
+        allocations += 3;
+        totalAllocations += 3;
+    }
+    heapBuffer.reset(capacity);
+    return heapBuffer;
+}
+
+// Functions to get the counters of this workspace
+long long SolverWorkspace::getAllocations() const
+{
+    return allocations;
+}
+
+long long SolverWorkspace::getRuns() const
+{
+    return runs;
+}
+
+// Functions to get the counters over all workspaces
+long long SolverWorkspace::getTotalAllocations()
+{
+    return totalAllocations;
+}
+
+long long SolverWorkspace::getTotalRuns()
+{
+    return totalRuns;
+}
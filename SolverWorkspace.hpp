@@ -0,0 +1,81 @@
+#ifndef SOLVERWORKSPACE_HPP
+#define SOLVERWORKSPACE_HPP
+
+#include "EdgeList.hpp"
+#include "IndexedHeap.hpp"
+#include "MST_tree.hpp"
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Scratch memory of the MST solvers and metric queries, one workspace per thread. A run borrows its buffers
+// here instead of building fresh vectors, and the buffers keep their capacity afterwards, so once a thread has
+// handled its largest graph, later runs do not allocate. Every time a buffer has to grow, it is counted, which
+// lets a steady state be checked for zero allocations.
+//
+// Borrowing a buffer again hands out the same memory, so a caller must be done with a buffer before anything
+// it calls borrows the same one. The solvers only borrow at the start of a run and never call each other
+class SolverWorkspace
+{
+public:
+    static const int INT_BUFFERS = 5;  // Number of int buffers
+    static const int LONG_BUFFERS = 3; // Number of long long buffers
+
+    // Function to get the calling thread's workspace
+    static SolverWorkspace &local();
+
+    // Function to count one solver run on this workspace
+    void beginRun();
+
+    // Function to borrow int buffer slot (0 .. INT_BUFFERS - 1), holding size copies of value
+    std::vector<int> &ints(int slot, size_t size, int value);
+
+    // Function to borrow int buffer slot empty, with room for capacity values (for buffers that are appended to)
+    std::vector<int> &emptyInts(int slot, size_t capacity);
+
+    // Function to borrow long long buffer slot (0 .. LONG_BUFFERS - 1), holding size copies of value
+    std::vector<long long> &longs(int slot, size_t size, long long value);
+
+    // Function to borrow the edge buffer empty, with room for capacity edges
+    EdgeList &edges(size_t capacity);
+
+    // Function to borrow the second edge buffer, sized for sorting the first one (see sortByWeight)
+    EdgeList &sortScratch(size_t capacity);
+
+    // Function to borrow the buffer of MST edges empty, with room for capacity edges
+    std::vector<MSTTree::Edge> &treeEdges(size_t capacity);
+
+    // Function to borrow the heap, reset for ids up to capacity - 1
+    IndexedHeap &heap(int capacity);
+
+    // Functions to get the number of buffer allocations and runs of this workspace
+    long long getAllocations() const;
+    long long getRuns() const;
+
+    // Functions to get the number of buffer allocations and runs over the workspaces of all threads
+    static long long getTotalAllocations();
+    static long long getTotalRuns();
+
+private:
+    std::vector<int> intBuffers[INT_BUFFERS];
+    std::vector<long long> longBuffers[LONG_BUFFERS];
+    EdgeList edgeBuffer;
+    EdgeList scratchBuffer;
+    std::vector<MSTTree::Edge> treeEdgeBuffer;
+    IndexedHeap heapBuffer;
+    int heapCapacity;     // Largest capacity the heap has been reset to
+    long long allocations; // Buffer growths of this workspace
+    long long runs;        // Runs counted by beginRun()
+
+    static std::atomic<long long> totalAllocations;
+    static std::atomic<long long> totalRuns;
+
+    SolverWorkspace();
+
+    // Helper function to count an allocation if holding count elements makes buffer grow
+    template <typename T>
+    void reserveCounted(std::vector<T> &buffer, size_t count);
+};
+
+#endif // SOLVERWORKSPACE_HPP
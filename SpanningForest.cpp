@@ -0,0 +1,180 @@
+#include "SpanningForest.hpp"
+#include "Parallel.hpp"
+#include "UnionFind.hpp"
+#include <memory>
+
+SpanningForest::SpanningForest(MSTFactory::AlgorithmType type, ActiveObject &pool, int numThreads)
+    : type(type), pool(pool), numThreads(numThreads > 0 ? numThreads : defaultThreadCount())
+{
+}
+
+// Function to label the connected components: every thread unites the endpoints of the edges of its own
+// vertex range in one shared lock-free union-find, whose roots are always the smallest vertex of their set
+int SpanningForest::labelComponents(const Graph &graph, int numThreads, std::vector<int> &component)
+{
+    int n = graph.getNumberOfVertices();
+    ConcurrentUnionFind components(n);
+    parallelFor(numThreads, n, [&](size_t begin, size_t end, int)
+                {
+        for (size_t u = begin; u < end; ++u)
+        {
+            int from = static_cast<int>(u);
+            graph.forEachNeighbor(from, [&](int v, int)
+                                  {
+                if (from < v)
+                {
+                    components.unite(from, v);
+                } });
+        } });
+
+    component.resize(n);
+    parallelFor(numThreads, n, [&](size_t begin, size_t end, int)
+                {
+        for (size_t v = begin; v < end; ++v)
+        {
+            component[v] = components.find(static_cast<int>(v));
+        } });
+
+    int count = 0;
+    for (int v = 0; v < n; ++v)
+    {
+        if (component[v] == v)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Minimum spanning forest: label the components, group their vertices, then hand the components to the pool
+// in batches of at least PARALLEL_MIN_CHUNK vertices (a big component gets a batch of its own, small ones share)
+MSTTree SpanningForest::computeMST(const Graph &graph)
+{
+    int n = graph.getNumberOfVertices();
+    std::vector<int> label;
+    int count = labelComponents(graph, numThreads, label);
+
+    // Number the components in order of their smallest vertex, then group the vertices by component
+    Partition partition;
+    std::vector<int> index(n, -1);
+    partition.offsets.assign(count + 1, 0);
+    for (int v = 0, next = 0; v < n; ++v)
+    {
+        if (label[v] == v)
+        {
+            index[v] = next++;
+        }
+        partition.offsets[index[label[v]] + 1]++;
+    }
+    for (int c = 0; c < count; ++c)
+    {
+        partition.offsets[c + 1] += partition.offsets[c];
+    }
+    partition.vertices.resize(n);
+    partition.local.resize(n);
+    std::vector<int> fill(partition.offsets.begin(), partition.offsets.end() - 1);
+    for (int v = 0; v < n; ++v)
+    {
+        int c = index[label[v]];
+        partition.local[v] = fill[c] - partition.offsets[c];
+        partition.vertices[fill[c]++] = v;
+    }
+
+    std::vector<std::vector<MSTTree::Edge>> treeEdges(count);
+    std::vector<MSTTree::Component> summaries(count);
+
+    // Cut the components into batches, then split the batches among the pool and wait until all are solved
+    std::vector<int> bounds(1, 0);
+    for (int first = 0; first < count;)
+    {
+        int last = first + 1;
+        while (last < count && partition.offsets[last] - partition.offsets[first] < static_cast<int>(PARALLEL_MIN_CHUNK))
+        {
+            last++;
+        }
+        bounds.push_back(last);
+        first = last;
+    }
+    std::atomic<int> pending(0);
+    int batches = static_cast<int>(bounds.size()) - 1;
+    if (batches > 0)
+    {
+        pool.spawn(pending, [&, batches]()
+                   { solveBatches(graph, partition, bounds, 0, batches, pending, treeEdges, summaries); });
+    }
+    pool.waitFor(pending);
+
+    std::vector<MSTTree::Edge> mstEdges;
+    mstEdges.reserve(n - count);
+    for (const std::vector<MSTTree::Edge> &edges : treeEdges)
+    {
+        mstEdges.insert(mstEdges.end(), edges.begin(), edges.end());
+    }
+
+    MSTTree forest(n, mstEdges);
+    forest.setComponents(std::move(summaries));
+    return forest;
+}
+
+// Helper function to solve a range of batches: halve it, spawning the upper half, until one batch is left
+void SpanningForest::solveBatches(const Graph &graph, const Partition &partition, const std::vector<int> &bounds,
+                                  int first, int last, std::atomic<int> &pending,
+                                  std::vector<std::vector<MSTTree::Edge>> &treeEdges,
+                                  std::vector<MSTTree::Component> &summaries) const
+{
+    while (last - first > 1)
+    {
+        int middle = first + (last - first) / 2;
+        pool.spawn(pending, [&, middle, last]()
+                   { solveBatches(graph, partition, bounds, middle, last, pending, treeEdges, summaries); });
+        last = middle;
+    }
+    solveComponents(graph, partition, bounds[first], bounds[last], treeEdges, summaries);
+}
+
+// Helper function to solve a run of components: each one is copied into a graph of its own (renumbered
+// 0 .. size - 1, same storage), solved, summarized and mapped back to the original vertex numbers
+void SpanningForest::solveComponents(const Graph &graph, const Partition &partition, int first, int last,
+                                     std::vector<std::vector<MSTTree::Edge>> &treeEdges,
+                                     std::vector<MSTTree::Component> &summaries) const
+{
+    std::unique_ptr<MSTAlgo> algo(MSTFactory::createMSTAlgorithm(type, numThreads));
+    algo->setCancelFlag(getCancelFlag()); // Cancelling the forest stops the component being solved too
+
+    for (int c = first; c < last && !isCancelled(); ++c) // Every component is a cancellation point
+    {
+        const int *vertices = partition.vertices.data() + partition.offsets[c];
+        int size = partition.offsets[c + 1] - partition.offsets[c];
+        MSTTree::Component &summary = summaries[c];
+        summary.representative = vertices[0];
+        summary.vertices = size;
+        summary.weight = 0;
+        summary.diameter = 0;
+        if (size == 1)
+        {
+            continue; // An isolated vertex is a tree of its own
+        }
+
+        Graph subgraph(size, graph.getStorage());
+        for (int i = 0; i < size; ++i)
+        {
+            int u = vertices[i];
+            graph.forEachNeighbor(u, [&](int v, int weight)
+                                  {
+                if (u < v)
+                {
+                    subgraph.addNewEdge(i, partition.local[v], weight); // Every edge is copied once
+                } });
+        }
+
+        MSTTree tree = algo->computeMST(subgraph);
+        std::vector<MSTTree::Edge> &edges = treeEdges[c];
+        edges.reserve(tree.getEdges().size());
+        for (const MSTTree::Edge &edge : tree.getEdges())
+        {
+            edges.push_back({vertices[edge.u], vertices[edge.v], edge.weight});
+        }
+        summary.weight = tree.getTotalWeight();
+        summary.diameter = tree.getLongestDistance();
+    }
+}
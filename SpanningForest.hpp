@@ -0,0 +1,55 @@
+#ifndef SPANNINGFOREST_HPP
+#define SPANNINGFOREST_HPP
+
+#include "MST_algo.hpp"
+#include "Activeobject.hpp"
+#include <atomic>
+#include <vector>
+#include <utility>
+
+// Minimum spanning forest by decomposition: the connected components of the graph are labeled in parallel with
+// a lock-free union-find, copied into subgraphs of their own and solved concurrently on an ActiveObject pool
+// (best a WORK_STEALING one, as the batches are spawned by recursive splitting),
+// with any of the MSTFactory algorithms. Every component's tree is summarized (weight, diameter) while its
+// task still has it at hand, so the returned MSTTree answers getComponents() from its cache
+class SpanningForest : public MSTAlgo
+{
+public:
+    // Constructor; the components are solved with the algorithm type on pool's threads. numThreads is used for
+    // the labeling and passed on to the parallel algorithms; 0 means one thread per hardware core
+    SpanningForest(MSTFactory::AlgorithmType type, ActiveObject &pool, int numThreads = 0);
+
+    MSTTree computeMST(const Graph &graph) override;
+
+    // Function to label the connected components of graph: component[v] becomes the smallest vertex of v's
+    // component. Returns the number of components
+    static int labelComponents(const Graph &graph, int numThreads, std::vector<int> &component);
+
+private:
+    // Vertices of all components, grouped by component (each group in increasing vertex order)
+    struct Partition
+    {
+        std::vector<int> vertices; // The groups, one after the other
+        std::vector<int> offsets;  // Group c is vertices[offsets[c] .. offsets[c + 1] - 1]
+        std::vector<int> local;    // Position of every vertex within its group
+    };
+
+    MSTFactory::AlgorithmType type; // Algorithm used for every component
+    ActiveObject &pool;             // Runs the per-component solves
+    int numThreads;                 // Threads for the labeling and the parallel algorithms
+
+    // Helper function to solve components [first, last) of partition one after the other, filling their
+    // slots of treeEdges (in graph's vertex numbers) and summaries
+    void solveComponents(const Graph &graph, const Partition &partition, int first, int last,
+                         std::vector<std::vector<MSTTree::Edge>> &treeEdges,
+                         std::vector<MSTTree::Component> &summaries) const;
+
+    // Helper function to solve batches [first, last): batch b is components bounds[b] .. bounds[b + 1] - 1.
+    // The upper half of the range is spawned on pool (counted by pending) and the lower half split again,
+    // down to one batch solved in place, so idle workers steal the biggest pieces first
+    void solveBatches(const Graph &graph, const Partition &partition, const std::vector<int> &bounds, int first,
+                      int last, std::atomic<int> &pending, std::vector<std::vector<MSTTree::Edge>> &treeEdges,
+                      std::vector<MSTTree::Component> &summaries) const;
+};
+
+#endif // SPANNINGFOREST_HPP
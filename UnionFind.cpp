@@ -0,0 +1,79 @@
+#include "UnionFind.hpp"
+#include <utility>
+
+// Constructor to create size singleton sets
+ConcurrentUnionFind::ConcurrentUnionFind(int size) : parent(new std::atomic<int>[size]), count(size)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        parent[i].store(i, std::memory_order_relaxed);
+    }
+}
+
+// Function to find the representative of x. Every visited vertex is pointed at its grandparent with a CAS;
+// a failed CAS only means another thread already shortened the path, so it is not retried
+int ConcurrentUnionFind::find(int x)
+{
+    while (true)
+    {
+        int p = parent[x].load(std::memory_order_acquire);
+        if (p == x)
+        {
+            return x;
+        }
+        int grandparent = parent[p].load(std::memory_order_acquire);
+        if (p != grandparent)
+        {
+            parent[x].compare_exchange_weak(p, grandparent, std::memory_order_acq_rel);
+        }
+        x = grandparent;
+    }
+}
+
+// Function to merge the sets of a and b. The root with the larger index is linked under the smaller one,
+// so concurrent links can never form a cycle. If the CAS fails the root moved, so look the roots up again
+bool ConcurrentUnionFind::unite(int a, int b)
+{
+    while (true)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+        {
+            return false;
+        }
+        if (a < b)
+        {
+            std::swap(a, b);
+        }
+        int expected = a;
+        if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+        {
+            return true;
+        }
+    }
+}
+
+// Function to check whether a and b are in the same set. Retries when a's root is linked away mid-check
+bool ConcurrentUnionFind::connected(int a, int b)
+{
+    while (true)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+        {
+            return true;
+        }
+        if (parent[a].load(std::memory_order_acquire) == a)
+        {
+            return false;
+        }
+    }
+}
+
+// Function to get the number of elements
+int ConcurrentUnionFind::size() const
+{
+    return count;
+}
@@ -0,0 +1,31 @@
+#ifndef UNIONFIND_HPP
+#define UNIONFIND_HPP
+
+#include <atomic>
+#include <memory>
+
+// Lock-free union-find: any number of threads may call find(), unite() and connected() concurrently
+class ConcurrentUnionFind
+{
+public:
+    // Constructor to create size singleton sets {0}, {1}, ..., {size - 1}
+    explicit ConcurrentUnionFind(int size);
+
+    // Function to find the representative of the set containing x (path halving)
+    int find(int x);
+
+    // Function to merge the sets of a and b; returns true only for the call that actually merged them
+    bool unite(int a, int b);
+
+    // Function to check whether a and b are currently in the same set
+    bool connected(int a, int b);
+
+    // Function to get the number of elements
+    int size() const;
+
+private:
+    std::unique_ptr<std::atomic<int>[]> parent; // parent[x] == x for roots
+    int count;                                  // Number of elements
+};
+
+#endif // UNIONFIND_HPP
@@ -0,0 +1,96 @@
+#include "WorkStealingDeque.hpp"
+
+WorkStealingDeque::Array::Array(size_t size) : mask(size - 1), slots(new std::atomic<Task *>[size])
+{
+}
+
+WorkStealingDeque::WorkStealingDeque(size_t capacity) : top(0), bottom(0)
+{
+    arrays.emplace_back(new Array(capacity));
+    array.store(arrays.back().get(), std::memory_order_relaxed);
+}
+
+// Destructor; deletes the tasks that were never run
+WorkStealingDeque::~WorkStealingDeque()
+{
+    Array *current = array.load(std::memory_order_relaxed);
+    for (long long i = top.load(std::memory_order_relaxed); i < bottom.load(std::memory_order_relaxed); ++i)
+    {
+        delete current->get(i);
+    }
+}
+
+// Function to push a task at the bottom. The task is written before bottom is published (release), so a thief
+// that sees the new bottom also sees the task
+void WorkStealingDeque::push(Task *task)
+{
+    long long b = bottom.load(std::memory_order_relaxed);
+    long long t = top.load(std::memory_order_acquire);
+    Array *current = array.load(std::memory_order_relaxed);
+    if (b - t > static_cast<long long>(current->mask))
+    {
+        // Full: copy the live tasks into an array twice as big
+        Array *grown = new Array(2 * (current->mask + 1));
+        for (long long i = t; i < b; ++i)
+        {
+            grown->put(i, current->get(i));
+        }
+        arrays.emplace_back(grown);
+        array.store(grown, std::memory_order_release);
+        current = grown;
+    }
+    current->put(b, task);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+// Function to pop the newest task. bottom is claimed first; only when a single task is left does the owner
+// race the thieves for it, on top
+WorkStealingDeque::Task *WorkStealingDeque::pop()
+{
+    long long b = bottom.load(std::memory_order_relaxed) - 1;
+    Array *current = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long t = top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        bottom.store(b + 1, std::memory_order_relaxed); // Empty
+        return nullptr;
+    }
+    Task *task = current->get(b);
+    if (t == b)
+    {
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            task = nullptr; // A thief took the last one
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+// Function to steal the oldest task; the thieves race each other (and the owner, for the last task) on top
+WorkStealingDeque::Task *WorkStealingDeque::steal()
+{
+    long long t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+    {
+        return nullptr;
+    }
+    Task *task = array.load(std::memory_order_acquire)->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr; // Lost the race
+    }
+    return task;
+}
+
+// Function to check whether the deque is empty
+bool WorkStealingDeque::empty() const
+{
+    return bottom.load(std::memory_order_seq_cst) <= top.load(std::memory_order_seq_cst);
+}
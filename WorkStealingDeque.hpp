@@ -0,0 +1,58 @@
+#ifndef WORKSTEALINGDEQUE_HPP
+#define WORKSTEALINGDEQUE_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Chase-Lev work-stealing deque of tasks (the C11 version of Lê, Pop, Cohen and Zappa Nardelli). One owner
+// thread pushes and pops at the bottom without taking a lock; any number of other threads steal from the top.
+// The deque owns the tasks it holds and deletes those left in it when destroyed
+class WorkStealingDeque
+{
+public:
+    typedef std::function<void()> Task;
+
+    // Constructor of an empty deque with room for capacity tasks (a power of two) before it grows
+    explicit WorkStealingDeque(size_t capacity = 256);
+
+    ~WorkStealingDeque();
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // Function for the owner to add a task at the bottom; the array doubles when full
+    void push(Task *task);
+
+    // Function for the owner to take the newest task from the bottom, or null if the deque is empty
+    Task *pop();
+
+    // Function for any other thread to take the oldest task from the top. Returns null if the deque is empty
+    // or another thread took that task first
+    Task *steal();
+
+    // Function to check whether the deque holds no task; only a hint while other threads use it
+    bool empty() const;
+
+private:
+    // Circular array of task slots, indexed modulo its size
+    struct Array
+    {
+        size_t mask;                                  // Size - 1
+        std::unique_ptr<std::atomic<Task *>[]> slots; // The tasks
+
+        explicit Array(size_t size);
+        // The slots publish the task itself (release/acquire), on top of the fences that order the indices
+        Task *get(long long index) const { return slots[index & mask].load(std::memory_order_acquire); }
+        void put(long long index, Task *task) { slots[index & mask].store(task, std::memory_order_release); }
+    };
+
+    std::atomic<long long> top;    // Next index to steal
+    std::atomic<long long> bottom; // Next index to push
+    std::atomic<Array *> array;    // The current array
+    std::vector<std::unique_ptr<Array>> arrays; // Every array so far: a thief may still read an old one, so
+                                                // they are only freed with the deque (owner only)
+};
+
+#endif // WORKSTEALINGDEQUE_HPP
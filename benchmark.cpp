@@ -0,0 +1,282 @@
+// Contributors: Wasim Shebalny, Shifaa Khatib.
+// Micro-benchmarks for the MST building blocks. Build and run with `make bench`.
+#include "Activeobject.hpp"
+#include "EdgeList.hpp"
+#include "MST_algo.hpp"
+#include "Protocol.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+
+// Function to fill an edge list with count random edges whose weights lie in [1, maxWeight]
+static EdgeList randomEdges(size_t count, int maxWeight, std::mt19937 &rng)
+{
+    EdgeList edges;
+    edges.reserve(count);
+    std::uniform_int_distribution<int> weight(1, maxWeight);
+    for (size_t i = 0; i < count; ++i)
+    {
+        edges.push(static_cast<int>(rng() % 100000), static_cast<int>(rng() % 100000), weight(rng));
+    }
+    return edges;
+}
+
+// Function to sort the edges by weight with std::sort on an index permutation (stable: ties keep their order).
+// The server only uses the insertion and radix sorts; this is the baseline they are measured against
+static void comparisonSortByWeight(EdgeList &edges)
+{
+    size_t count = edges.size();
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+              { return edges.weights[a] < edges.weights[b] || (edges.weights[a] == edges.weights[b] && a < b); });
+
+    EdgeList sorted;
+    sorted.reserve(count);
+    for (size_t i : order)
+    {
+        sorted.push(edges.from[i], edges.to[i], edges.weights[i]);
+    }
+    std::swap(edges, sorted);
+}
+
+// Function to measure the average time (in microseconds) one sort of count edges takes
+template <typename Sort>
+static double timeSort(Sort sort, size_t count, int maxWeight)
+{
+    std::mt19937 rng(42);
+    size_t repeats = std::max(static_cast<size_t>(3), (1 << 22) / std::max(count, static_cast<size_t>(1)));
+    std::vector<EdgeList> inputs;
+    for (size_t i = 0; i < repeats; ++i)
+    {
+        inputs.push_back(randomEdges(count, maxWeight, rng));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (EdgeList &edges : inputs)
+    {
+        sort(edges);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / repeats;
+}
+
+// Compares the comparison sorts and the radix sort of Kruskal's edge list and reports where radix starts to beat
+// the insertion sort that sortByWeight() uses for short lists
+static void benchmarkEdgeSort()
+{
+    const int maxWeights[] = {255, 65535, 2147483647};
+    for (int maxWeight : maxWeights)
+    {
+        std::printf("Edge sort, weights in [1, %d]\n", maxWeight);
+        std::printf("%10s %14s %14s %14s\n", "edges", "insertion us", "std::sort us", "radix us");
+        size_t crossover = 0;
+        for (size_t count = 8; count <= (1 << 20); count *= 2)
+        {
+            bool small = count <= 1024; // Insertion sort is quadratic, so it is only timed on short lists
+            double insertion = small ? timeSort(insertionSortByWeight, count, maxWeight) : 0;
+            double comparison = timeSort(comparisonSortByWeight, count, maxWeight);
+            double radix = timeSort(static_cast<void (*)(EdgeList &)>(radixSortByWeight), count, maxWeight);
+            std::printf("%10zu %14s %14.2f %14.2f\n", count, small ? std::to_string(insertion).c_str() : "-", comparison, radix);
+            if (crossover == 0 && small && radix < insertion)
+            {
+                crossover = count;
+            }
+        }
+        std::printf("Radix sort is faster from %zu edges (RADIX_SORT_THRESHOLD = %zu)\n\n", crossover, RADIX_SORT_THRESHOLD);
+    }
+}
+
+// Function to build a graph with n vertices where each possible edge exists with the given probability
+static Graph randomGraph(int n, double density, Graph::Storage storage, std::mt19937 &rng)
+{
+    Graph graph(n, storage);
+    std::bernoulli_distribution present(density);
+    std::uniform_int_distribution<int> weight(1, 1000000);
+    for (int u = 0; u < n; ++u)
+    {
+        for (int v = u + 1; v < n; ++v)
+        {
+            if (present(rng))
+            {
+                graph.addEdge(u, v, weight(rng));
+            }
+        }
+    }
+    return graph;
+}
+
+// Function to measure the time (in milliseconds) one Prim run in the given mode takes
+static double timePrim(Prim::Mode mode, const Graph &graph)
+{
+    Prim prim(mode);
+    auto start = std::chrono::steady_clock::now();
+    prim.computeMST(graph);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Compares dense-scan Prim against heap Prim for growing edge densities
+static void benchmarkPrimModes()
+{
+    const int n = 2000;
+    const double densities[] = {0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0};
+    std::mt19937 rng(7);
+    std::printf("Prim on %d vertices (SIMD: %s)\n", n, simdInstructionSet());
+    std::printf("%10s %10s %16s %16s %16s %10s\n", "density", "edges", "scan (dense) ms", "scan (sparse) ms", "heap (sparse) ms", "auto");
+    for (double density : densities)
+    {
+        Graph dense = randomGraph(n, density, Graph::DENSE, rng);
+        Graph sparse = randomGraph(n, density, Graph::SPARSE, rng);
+        std::printf("%10.3f %10d %16.2f %16.2f %16.2f %10s\n", density, sparse.getNumberOfEdges(),
+                    timePrim(Prim::DENSE_SCAN, dense), timePrim(Prim::DENSE_SCAN, sparse), timePrim(Prim::HEAP, sparse),
+                    Prim::prefersDenseScan(sparse) ? "scan" : "heap");
+    }
+    std::printf("\n");
+}
+
+// Function to measure the average time (in nanoseconds) parse takes per request, over many rounds of requests
+template <typename Parse>
+static double timeParse(Parse parse, const std::vector<std::string> &requests)
+{
+    const int rounds = 200000;
+    long long checksum = 0; // Keeps the parsing from being optimized away
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const std::string &request : requests)
+        {
+            checksum += parse(request);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (checksum == 42)
+    {
+        std::printf(" ");
+    }
+    return ns / (static_cast<double>(rounds) * requests.size());
+}
+
+// Compares the tokenizer and dispatch of Protocol.hpp against the stringstream parsing and substring matching
+// the server used before, on a mix of commands
+static void benchmarkCommandParsing()
+{
+    const std::vector<std::string> requests = {"add 123 4567 89", "shortest distance 12 345", "solve kruskal", "remove 17 42",
+                                               "longest distance", "components", "add 99999 1 100000", "avg distance"};
+
+    double tokenizer = timeParse([](const std::string &request)
+                                 {
+        Tokenizer args(request.data(), request.size());
+        long long sum = parseCommand(args);
+        int value;
+        while (args.nextInt(value))
+        {
+            sum += value;
+        }
+        return sum; }, requests);
+
+    double stringstream = timeParse([](const std::string &request)
+                                    {
+        std::stringstream ss(request);
+        std::string command;
+        ss >> command;
+        long long sum = 0;
+        if (request.find("longest distance") != std::string::npos || request.find("avg distance") != std::string::npos)
+        {
+            return sum + 1;
+        }
+        if (request.find("shortest distance") != std::string::npos)
+        {
+            sum += 2;
+        }
+        else if (command == "components" || command == "workspace" || command == "create" || command == "add" ||
+                 command == "remove" || command == "solve")
+        {
+            sum += command.size();
+        }
+        int value;
+        while (ss >> value)
+        {
+            sum += value;
+        }
+        return sum; }, requests);
+
+    std::printf("Command parsing, %zu mixed requests\n", requests.size());
+    std::printf("%28s %28s\n", "tokenizer + table ns/cmd", "stringstream + find ns/cmd");
+    std::printf("%28.1f %28.1f\n\n", tokenizer, stringstream);
+}
+
+// Function to sum [first, last) by recursive halving on pool, down to leaves of leafSize values: every split
+// spawns its upper half, the way the spanning forest splits its batches
+static void forkJoinSum(ActiveObject &pool, const std::vector<int> &values, size_t first, size_t last, size_t leafSize,
+                        std::atomic<long long> &sum, std::atomic<int> &pending)
+{
+    while (last - first > leafSize)
+    {
+        size_t middle = first + (last - first) / 2;
+        pool.spawn(pending, [&pool, &values, middle, last, leafSize, &sum, &pending]()
+                   { forkJoinSum(pool, values, middle, last, leafSize, sum, pending); });
+        last = middle;
+    }
+    long long local = 0;
+    for (size_t i = first; i < last; ++i)
+    {
+        local += values[i];
+    }
+    sum.fetch_add(local, std::memory_order_relaxed);
+}
+
+// Function to measure the time (in milliseconds) one fork-join sum of values takes on pool
+static double timeForkJoin(ActiveObject &pool, const std::vector<int> &values, size_t leafSize)
+{
+    const int rounds = 20;
+    std::atomic<long long> sum(0);
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        std::atomic<int> pending(0);
+        pool.spawn(pending, [&]()
+                   { forkJoinSum(pool, values, 0, values.size(), leafSize, sum, pending); });
+        pool.waitFor(pending);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (sum.load() == 42)
+    {
+        std::printf(" ");
+    }
+    return ms / rounds;
+}
+
+// Compares the shared task queue of ActiveObject against its work-stealing deques on recursively spawned
+// tasks of shrinking size, one worker per core
+static void benchmarkScheduling()
+{
+    const size_t leafSizes[] = {16384, 4096, 1024, 256};
+    std::vector<int> values(1 << 22, 1);
+    int threads = defaultThreadCount();
+    ActiveObject shared(threads, ActiveObject::SHARED_QUEUE);
+    ActiveObject stealing(threads, ActiveObject::WORK_STEALING);
+    std::printf("Fork-join sum of %zu values on %d workers\n", values.size(), threads);
+    std::printf("%10s %10s %16s %16s\n", "leaf", "tasks", "shared queue ms", "work stealing ms");
+    for (size_t leafSize : leafSizes)
+    {
+        std::printf("%10zu %10zu %16.2f %16.2f\n", leafSize, values.size() / leafSize, timeForkJoin(shared, values, leafSize),
+                    timeForkJoin(stealing, values, leafSize));
+    }
+    std::printf("\n");
+}
+
+int main()
+{
+    benchmarkEdgeSort();
+    benchmarkPrimModes();
+    benchmarkCommandParsing();
+    benchmarkScheduling();
+    return 0;
+}
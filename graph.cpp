@@ -1,10 +1,20 @@
 #include "graph.hpp"
+#include <algorithm>
+#include <random>
 
 // Constructor: Initializes the graph with the given number of vertices
-Graph::Graph(int vertices) : numVertices(vertices), numEdges(0)
+Graph::Graph(int vertices, Storage storage) : storage(storage), numVertices(vertices), numEdges(0), contentHash(0)
 {
-    // Initialize the adjacency matrix with 0 (no edge) for all vertex pairs
-    adjMat.resize(numVertices, std::vector<int>(numVertices, 0));
+    if (storage == DENSE)
+    {
+        // Initialize the adjacency matrix with 0 (no edge) for all vertex pairs
+        adjMat.resize(numVertices, std::vector<int>(numVertices, 0));
+    }
+    else
+    {
+        // One empty edge list per vertex
+        adjList.resize(numVertices);
+    }
 }
 
 // Function to add an edge from vertex u to vertex v with weight w
@@ -16,13 +26,162 @@ void Graph::addEdge(int u, int v, int weight)
         return;
     }
 
-    if (adjMat[u][v] == 0)
+    // A weight of 0 means "no edge" in both backends
+    if (weight == 0)
+    {
+        removeEdge(u, v);
+        return;
+    }
+
+    if (storage == DENSE)
+    {
+        if (adjMat[u][v] == 0)
+        {
+            numEdges++; // Increment edge count if a new edge is added
+        }
+        else
+        {
+            contentHash -= edgeHash(u, v, adjMat[u][v]); // The old weight goes out of the hash
+        }
+        contentHash += edgeHash(u, v, weight);
+
+        adjMat[u][v] = weight; // Add edge from u to v
+        adjMat[v][u] = weight; // Add edge from v to u (undirected)
+        return;
+    }
+
+    int pos = findNeighbor(u, v);
+    if (pos != -1)
+    {
+        // The edge already exists, only update its weight on both sides
+        contentHash += edgeHash(u, v, weight) - edgeHash(u, v, adjList[u][pos].weight);
+        adjList[u][pos].weight = weight;
+        if (u != v)
+        {
+            adjList[v][findNeighbor(v, u)].weight = weight;
+        }
+        return;
+    }
+
+    adjList[u].push_back({v, weight});
+    if (u != v)
+    {
+        adjList[v].push_back({u, weight}); // Undirected
+    }
+    numEdges++;
+    contentHash += edgeHash(u, v, weight);
+}
+
+// Function to add an edge that is known to be new: no bounds, zero-weight or duplicate checks
+void Graph::addNewEdge(int u, int v, int weight)
+{
+    if (storage == DENSE)
+    {
+        addEdge(u, v, weight); // Already O(1)
+        return;
+    }
+
+    adjList[u].push_back({v, weight});
+    if (u != v)
+    {
+        adjList[v].push_back({u, weight}); // Undirected
+    }
+    numEdges++;
+    contentHash += edgeHash(u, v, weight);
+}
+
+// Function to add many edges: append them all, then drop the older copies of edges that appear twice
+size_t Graph::addEdges(const EdgeList &edges)
+{
+    auto skipped = [&](size_t i)
+    {
+        int u = edges.from[i];
+        int v = edges.to[i];
+        return u < 0 || u >= numVertices || v < 0 || v >= numVertices || edges.weights[i] == 0;
+    };
+
+    if (storage == DENSE)
+    {
+        size_t accepted = 0;
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            if (!skipped(i))
+            {
+                addEdge(edges.from[i], edges.to[i], edges.weights[i]); // Already O(1)
+                accepted++;
+            }
+        }
+        return accepted;
+    }
+
+    std::vector<int> added(numVertices, 0); // Entries each edge list grows by
+    size_t accepted = 0;
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        if (skipped(i))
+        {
+            continue;
+        }
+        int u = edges.from[i];
+        int v = edges.to[i];
+        accepted++;
+        added[u]++;
+        if (u != v)
+        {
+            added[v]++;
+        }
+    }
+
+    for (int u = 0; u < numVertices; ++u)
     {
-        numEdges++; // Increment edge count if a new edge is added
+        adjList[u].reserve(adjList[u].size() + added[u]);
+    }
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        if (skipped(i))
+        {
+            continue;
+        }
+        int u = edges.from[i];
+        int v = edges.to[i];
+        adjList[u].push_back({v, edges.weights[i]});
+        if (u != v)
+        {
+            adjList[v].push_back({u, edges.weights[i]});
+        }
     }
 
-    adjMat[u][v] = weight; // Add edge from u to v
-    adjMat[v][u] = weight; // Add edge from v to u (undirected)
+    // Keep the last entry of each neighbor: walking a list backwards, added[v] == u marks v as already kept.
+    // Both lists of an edge keep the entry of the same (last) copy, so the weights stay symmetric
+    std::fill(added.begin(), added.end(), -1);
+    long long entries = 0;
+    int selfLoops = 0;
+    contentHash = 0; // Recomputed from the kept entries, once per edge (from its smaller end)
+    for (int u = 0; u < numVertices; ++u)
+    {
+        std::vector<Neighbor> &list = adjList[u];
+        size_t kept = list.size();
+        for (size_t i = list.size(); i-- > 0;)
+        {
+            if (added[list[i].vertex] != u)
+            {
+                added[list[i].vertex] = u;
+                list[--kept] = list[i];
+            }
+        }
+        list.erase(list.begin(), list.begin() + kept);
+        for (const Neighbor &neighbor : list)
+        {
+            if (neighbor.vertex >= u)
+            {
+                contentHash += edgeHash(u, neighbor.vertex, neighbor.weight);
+            }
+        }
+        entries += list.size();
+        selfLoops += (added[u] == u) ? 1 : 0;
+    }
+    numEdges = static_cast<int>((entries + selfLoops) / 2); // A self-loop has one entry, any other edge two
+    return accepted;
 }
 
 // Function to remove an edge from vertex u to vertex v
@@ -34,11 +193,36 @@ void Graph::removeEdge(int u, int v)
         return;
     }
 
-    if (adjMat[u][v] != 0)
+    if (storage == DENSE)
     {
-        adjMat[u][v] = 0; // Set the edge weight to 0 (indicating no edge)
-        numEdges--;       // Decrement the edge count
+        if (adjMat[u][v] != 0)
+        {
+            contentHash -= edgeHash(u, v, adjMat[u][v]);
+            adjMat[u][v] = 0; // Set the edge weight to 0 (indicating no edge)
+            adjMat[v][u] = 0; // Undirected, so clear both directions
+            numEdges--;       // Decrement the edge count
+        }
+        return;
     }
+
+    int pos = findNeighbor(u, v);
+    if (pos == -1)
+    {
+        return;
+    }
+
+    contentHash -= edgeHash(u, v, adjList[u][pos].weight);
+
+    // Order inside an edge list does not matter, so swap with the last entry and pop
+    adjList[u][pos] = adjList[u].back();
+    adjList[u].pop_back();
+    if (u != v)
+    {
+        int back = findNeighbor(v, u);
+        adjList[v][back] = adjList[v].back();
+        adjList[v].pop_back();
+    }
+    numEdges--;
 }
 
 // Function to get the number of vertices
@@ -53,10 +237,125 @@ int Graph::getNumberOfEdges() const
     return numEdges;
 }
 
-// Function to return the adjacency matrix
+// Function to get the storage backend of the graph
+Graph::Storage Graph::getStorage() const
+{
+    return storage;
+}
+
+// Function to get the hash of the edge set
+unsigned long long Graph::getContentHash() const
+{
+    return contentHash;
+}
+
+// Function to estimate the memory the graph takes: the object plus its rows and their entries
+size_t Graph::getMemoryUsage() const
+{
+    size_t bytes = sizeof(Graph);
+    for (const std::vector<int> &row : adjMat)
+    {
+        bytes += sizeof(row) + row.capacity() * sizeof(int);
+    }
+    for (const std::vector<Neighbor> &list : adjList)
+    {
+        bytes += sizeof(list) + list.capacity() * sizeof(Neighbor);
+    }
+    return bytes;
+}
+
+// Helper function to mix the bits of a 64-bit value (the SplitMix64 finalizer)
+static unsigned long long mix64(unsigned long long value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// Helper function to get the key of the edge hashes, drawn at random the first time it is needed: without it,
+// a client cannot build graphs whose content hashes collide
+static unsigned long long hashKey()
+{
+    static const unsigned long long key = []()
+    {
+        std::random_device device;
+        return (static_cast<unsigned long long>(device()) << 32) ^ device();
+    }();
+    return key;
+}
+
+// Helper function to hash the undirected edge (u, v) with its weight: the ends in order are mixed with the key,
+// then the weight, so that the sum over the edges changes with any edit
+unsigned long long Graph::edgeHash(int u, int v, int weight)
+{
+    unsigned long long ends = static_cast<unsigned long long>(static_cast<unsigned>(std::min(u, v))) << 32 |
+                              static_cast<unsigned>(std::max(u, v));
+    return mix64(mix64(ends ^ hashKey()) ^ static_cast<unsigned>(weight));
+}
+
+// Function to compare the edge sets: the weights of u's edges in this graph are spread over a row indexed by
+// the other end, then each edge of u in other must find its weight there (0 marks no edge, as in adjMat)
+bool Graph::hasSameEdges(const Graph &other) const
+{
+    if (numVertices != other.numVertices || numEdges != other.numEdges || contentHash != other.contentHash)
+    {
+        return false;
+    }
+    if (storage == DENSE && other.storage == DENSE)
+    {
+        return adjMat == other.adjMat;
+    }
+    std::vector<int> weights(numVertices, 0);
+    for (int u = 0; u < numVertices; ++u)
+    {
+        int degree = 0;
+        forEachNeighbor(u, [&](int v, int weight) {
+            weights[v] = weight;
+            degree++;
+        });
+        bool same = true;
+        other.forEachNeighbor(u, [&](int v, int weight) {
+            same = same && weights[v] == weight;
+            degree--;
+        });
+        forEachNeighbor(u, [&](int v, int) { weights[v] = 0; });
+        if (!same || degree != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper function to find the position of v in the edge list of u, or -1
+int Graph::findNeighbor(int u, int v) const
+{
+    const std::vector<Neighbor> &list = adjList[u];
+    for (size_t i = 0; i < list.size(); ++i)
+    {
+        if (list[i].vertex == v)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Function to return the adjacency matrix (built on demand for SPARSE storage)
 std::vector<std::vector<int>> Graph::getAdjacencyMatrix() const
 {
-    return adjMat;
+    if (storage == DENSE)
+    {
+        return adjMat;
+    }
+
+    std::vector<std::vector<int>> matrix(numVertices, std::vector<int>(numVertices, 0));
+    for (int u = 0; u < numVertices; ++u)
+    {
+        forEachNeighbor(u, [&](int v, int weight)
+                        { matrix[u][v] = weight; });
+    }
+    return matrix;
 }
 
 // Function to print the adjacency matrix (optional for debugging)
@@ -64,9 +363,13 @@ void Graph::printAdjacencyMatrix() const
 {
     for (int i = 0; i < numVertices; ++i)
     {
+        // Expand one row at a time instead of materializing the whole matrix
+        std::vector<int> weights(numVertices, 0);
+        forEachNeighbor(i, [&](int v, int weight)
+                        { weights[v] = weight; });
         for (int j = 0; j < numVertices; ++j)
         {
-            std::cout << adjMat[i][j] << " ";
+            std::cout << weights[j] << " ";
         }
         std::cout << std::endl;
     }
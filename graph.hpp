@@ -3,20 +3,76 @@
 
 #include <vector>
 #include <iostream>
+#include <cstddef>
+#include "EdgeList.hpp"
+
+// Read-only, non-owning view over a contiguous run of T (a minimal std::span)
+template <typename T>
+class RowView
+{
+private:
+    const T *first; // First element of the view
+    size_t count;   // Number of elements in the view
+
+public:
+    RowView(const T *data, size_t size) : first(data), count(size) {}
+
+    const T *begin() const { return first; }
+    const T *end() const { return first + count; }
+    const T *data() const { return first; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T &operator[](size_t i) const { return first[i]; }
+};
 
 class Graph
 {
+public:
+    // Storage backend, chosen when the graph is created
+    enum Storage
+    {
+        DENSE, // n x n adjacency matrix, O(n^2) memory
+        SPARSE // Per-vertex edge lists, O(n + E) memory
+    };
+
+    // One entry of a vertex's edge list
+    struct Neighbor
+    {
+        int vertex; // The adjacent vertex
+        int weight; // The weight of the edge to it
+    };
+
 private:
-    std::vector<std::vector<int>> adjMat; // Adjacency matrix to represent the graph
-    int numVertices;                      // Number of vertices
-    int numEdges;                         // Number of edges
+    Storage storage;                             // Which of the two containers below is in use
+    std::vector<std::vector<int>> adjMat;        // Adjacency matrix (DENSE storage only)
+    std::vector<std::vector<Neighbor>> adjList;  // Edge lists (SPARSE storage only)
+    int numVertices;                             // Number of vertices
+    int numEdges;                                // Number of edges
+    unsigned long long contentHash;              // Sum of edgeHash() over the edges, see getContentHash()
+
+    // Helper function to find the position of v in the edge list of u, or -1
+    int findNeighbor(int u, int v) const;
+
+    // Helper function to hash one undirected edge (u, v) of the given weight
+    static unsigned long long edgeHash(int u, int v, int weight);
+
 public:
     // Constructor to initialize the graph with a specific number of vertices
-    Graph(int vertices);
+    Graph(int vertices, Storage storage = SPARSE);
 
     // Function to add an edge from vertex u to vertex v with weight w
     void addEdge(int u, int v, int weight);
 
+    // Function to add an edge the caller knows is not in the graph yet, skipping the duplicate lookup of
+    // addEdge() (O(1) instead of O(deg(u)) for SPARSE storage). Meant for copying edges out of another graph
+    void addNewEdge(int u, int v, int weight);
+
+    // Function to add many edges at once, in O(n + E) for SPARSE storage: each edge list grows once and no
+    // duplicate lookups are made. Equivalent to addEdge() for each edge in order (a later copy of an edge
+    // overrides its weight), except that edges with a weight of 0 or an invalid vertex are skipped.
+    // Returns the number of edges that were not skipped
+    size_t addEdges(const EdgeList &edges);
+
     // Function to remove an edge from vertex u to vertex v
     void removeEdge(int u, int v);
 
@@ -26,7 +82,72 @@ public:
     // Function to get the number of edges
     int getNumberOfEdges() const;
 
-    // Function to return the adjacency matrix
+    // Function to get the storage backend of the graph
+    Storage getStorage() const;
+
+    // Function to get a hash of the edge set (endpoints and weights, in any order and either storage). It is
+    // the sum of one strong hash per edge, so addEdge() and removeEdge() keep it up to date in O(1). The edge
+    // hash is keyed with a random value drawn once per process, so the hash differs between runs of the server
+    unsigned long long getContentHash() const;
+
+    // Function to check whether other has exactly the same vertices and edges (with their weights), whatever
+    // the storage of either; equal content hashes do not prove it. O(n + E) for SPARSE, O(n^2) for DENSE
+    bool hasSameEdges(const Graph &other) const;
+
+    // Function to estimate the memory the graph takes, in bytes
+    size_t getMemoryUsage() const;
+
+    // Function to get the weight of the edge (u, v), or 0 if there is no such edge.
+    // O(1) for DENSE storage and O(deg(u)) for SPARSE storage
+    int weight(int u, int v) const
+    {
+        if (storage == DENSE)
+        {
+            return adjMat[u][v];
+        }
+
+        int pos = findNeighbor(u, v);
+        return (pos == -1) ? 0 : adjList[u][pos].weight;
+    }
+
+    // Function to get row u of the adjacency matrix without copying (DENSE storage only)
+    RowView<int> row(int u) const
+    {
+        return RowView<int>(adjMat[u].data(), adjMat[u].size());
+    }
+
+    // Function to get the edge list of vertex u without copying (SPARSE storage only)
+    RowView<Neighbor> neighbors(int u) const
+    {
+        return RowView<Neighbor>(adjList[u].data(), adjList[u].size());
+    }
+
+    // Calls visit(v, weight) for every edge (u, v); costs O(n) for DENSE and O(deg(u)) for SPARSE
+    template <typename Visitor>
+    void forEachNeighbor(int u, Visitor visit) const
+    {
+        if (storage == DENSE)
+        {
+            RowView<int> weights = row(u);
+            for (int v = 0; v < numVertices; ++v)
+            {
+                if (weights[v] != 0)
+                {
+                    visit(v, weights[v]);
+                }
+            }
+        }
+        else
+        {
+            for (const Neighbor &neighbor : neighbors(u))
+            {
+                visit(neighbor.vertex, neighbor.weight);
+            }
+        }
+    }
+
+    // Function to return a copy of the adjacency matrix (built on demand for SPARSE storage).
+    // Meant for debugging only: use weight(), row(), neighbors() or forEachNeighbor() in algorithms
     std::vector<std::vector<int>> getAdjacencyMatrix() const;
 
     // Function to print the adjacency matrix (optional for debugging)
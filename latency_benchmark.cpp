@@ -0,0 +1,241 @@
+// Contributors: Wasim Shebalny, Shifaa Khatib.
+// Connection latency of the two server designs: Leader-Follower (the default) and the reactor that hands
+// commands to ActiveObject workers (--reactor). Starts ./server once per design and measures, from the client
+// side, how long it takes to connect, send one command and get its reply. Build and run with `make bench-latency`.
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+const int PORT = 8080;              // Port the server listens on
+const int SEQUENTIAL_CONNECTIONS = 500; // Connections opened one after the other
+const int CONCURRENT_CLIENTS = 32;  // Client threads of the concurrent runs
+const int CONNECTIONS_PER_CLIENT = 50; // Connections each of those threads opens
+const int REQUESTS_PER_CLIENT = 200; // Requests each client sends over one persistent connection
+
+// A running server: its process and the pipe to its console
+struct ServerProcess
+{
+    pid_t pid;
+    int console;
+};
+
+// Function to open a connection to the server, or return -1
+static int connectToServer()
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+// Function to send one command and read its reply (every reply used here is one line)
+static bool request(int fd, const std::string &command)
+{
+    if (send(fd, command.data(), command.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(command.size()))
+    {
+        return false;
+    }
+    char buffer[256];
+    while (true)
+    {
+        ssize_t bytesRead = recv(fd, buffer, sizeof(buffer), 0);
+        if (bytesRead <= 0)
+        {
+            return false;
+        }
+        if (buffer[bytesRead - 1] == '\n')
+        {
+            return true;
+        }
+    }
+}
+
+// Function to start ./server with the given flag (or none) and wait until it accepts connections
+static ServerProcess startServer(const char *flag)
+{
+    int console[2];
+    if (pipe(console) < 0)
+    {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        dup2(console[0], STDIN_FILENO);
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        close(console[1]);
+        execl("./server", "./server", flag, static_cast<char *>(nullptr));
+        perror("execl ./server");
+        _exit(EXIT_FAILURE);
+    }
+    close(console[0]);
+
+    for (int attempt = 0; attempt < 1200; ++attempt) // The server calibrates its cost model first
+    {
+        int fd = connectToServer();
+        if (fd >= 0)
+        {
+            close(fd);
+            return {pid, console[1]};
+        }
+        usleep(50 * 1000);
+    }
+    std::fprintf(stderr, "The server did not start\n");
+    exit(EXIT_FAILURE);
+}
+
+// Function to shut the server down through its console and wait for it to exit
+static void stopServer(const ServerProcess &server)
+{
+    const char command[] = "shutdown\n";
+    if (write(server.console, command, sizeof(command) - 1) < 0)
+    {
+        kill(server.pid, SIGTERM);
+    }
+    close(server.console);
+    waitpid(server.pid, nullptr, 0);
+}
+
+// Function to print the mean, median and 99th percentile of latencies (in microseconds)
+static void report(const char *name, std::vector<double> &latencies, double seconds)
+{
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0;
+    for (double latency : latencies)
+    {
+        sum += latency;
+    }
+    size_t count = latencies.size();
+    std::printf("  %-40s %10.1f %10.1f %10.1f %12.0f\n", name, count ? sum / count : 0.0, count ? latencies[count / 2] : 0.0,
+                count ? latencies[std::min(count - 1, count * 99 / 100)] : 0.0, seconds > 0 ? count / seconds : 0.0);
+}
+
+// Function to time one connect + "create" + reply + close cycle, in microseconds (-1 on failure)
+static double timeConnection()
+{
+    auto start = std::chrono::steady_clock::now();
+    int fd = connectToServer();
+    if (fd < 0 || !request(fd, "create 3\n"))
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    close(fd);
+    return micros;
+}
+
+// Function to run body(client, latencies) on CONCURRENT_CLIENTS threads and collect their latencies
+template <typename Body>
+static double runConcurrently(Body body, std::vector<double> &latencies)
+{
+    std::vector<std::vector<double>> perClient(CONCURRENT_CLIENTS);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int client = 0; client < CONCURRENT_CLIENTS; ++client)
+    {
+        clients.emplace_back([&, client]()
+                             { body(perClient[client]); });
+    }
+    for (std::thread &client : clients)
+    {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const std::vector<double> &own : perClient)
+    {
+        latencies.insert(latencies.end(), own.begin(), own.end());
+    }
+    return seconds;
+}
+
+// Function to measure one server design
+static void benchmarkServer(const char *name, const char *flag)
+{
+    ServerProcess server = startServer(flag);
+    std::printf("%s\n", name);
+    std::printf("  %-40s %10s %10s %10s %12s\n", "", "mean us", "p50 us", "p99 us", "per second");
+
+    std::vector<double> latencies;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < SEQUENTIAL_CONNECTIONS; ++i)
+    {
+        double micros = timeConnection();
+        if (micros >= 0)
+        {
+            latencies.push_back(micros);
+        }
+    }
+    report("connect + request, 1 client", latencies, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    latencies.clear();
+    double seconds = runConcurrently([](std::vector<double> &own)
+                                     {
+        for (int i = 0; i < CONNECTIONS_PER_CLIENT; ++i)
+        {
+            double micros = timeConnection();
+            if (micros >= 0)
+            {
+                own.push_back(micros);
+            }
+        } }, latencies);
+    report("connect + request, 32 clients", latencies, seconds);
+
+    latencies.clear();
+    seconds = runConcurrently([](std::vector<double> &own)
+                              {
+        int fd = connectToServer();
+        if (fd < 0 || !request(fd, "create 3\n"))
+        {
+            return;
+        }
+        for (int i = 0; i < REQUESTS_PER_CLIENT; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (!request(fd, "add 0 1 5\n"))
+            {
+                break;
+            }
+            own.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        close(fd); }, latencies);
+    report("request on open connection, 32 clients", latencies, seconds);
+
+    stopServer(server);
+    std::printf("\n");
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+    benchmarkServer("Leader-Follower (shared epoll, EPOLLONESHOT)", nullptr);
+    benchmarkServer("Reactor + ActiveObject workers (--reactor)", "--reactor");
+    return 0;
+}
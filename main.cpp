@@ -2,277 +2,825 @@
 #include <thread>    // Thread library to create parallel threads
 #include <netinet/in.h> // Socket programming library, specifically for TCP/IP protocol
 #include <unistd.h>  // Unix standard library for system functions like close()
-#include <sstream>   // String stream library to process strings
 #include <string>    
 #include <atomic>    // Provides atomic variables that can be safely used in multi-threaded programs
-#include <queue>     // Queue library for storing client requests in order
-#include <condition_variable> // Used for thread synchronization and signaling
-#include <mutex>     // Provides mutexes to protect shared resources between threads
-#include <set>       
+#include <chrono>    // Clocks to time the MST solves
 #include "MST_algo.hpp" 
+#include "CostModel.hpp"
+#include "SpanningForest.hpp"
+#include "SolverWorkspace.hpp"
+#include "Parallel.hpp"
 #include "graph.hpp"    
 #include "Pipeline.hpp" 
+#include "Protocol.hpp"
 #include "Activeobject.hpp"
+#include "Connection.hpp"
+#include "GraphRegistry.hpp"
+#include "MSTCache.hpp"
+#include "Reactor.hpp"
+#include "LeaderFollower.hpp"
+#include <functional>
+#include <climits>
+#include <cstdint>
 
 #define PORT 8080 // The port number the server listens on
-#define BUFFER_SIZE 1024 // Size of the buffer used to read data from clients
-#define THREAD_POOL_SIZE 4 // Number of threads in the server's thread pool
-
-// Global variables for thread synchronization
-std::mutex leaderMutex; // Mutex for the Leader-Follower pattern
-std::condition_variable leaderCV; // Condition variable for managing leader threads
-std::queue<int> clientQueue; // Queue to hold the client sockets waiting to be processed
-
-// Set to store all active client sockets
-std::set<int> activeClientSockets;
-std::mutex clientSocketMutex; // Mutex to protect access to activeClientSockets
+#define THREAD_POOL_SIZE 4 // Number of threads serving clients
+#define MST_CACHE_BYTES (256UL * 1024 * 1024) // Memory the cache of solved MSTs may hold
+#define SOLVE_JOB_THREADS 2 // Threads running the "solve async" jobs of all clients
+#define MAX_SOLVE_JOBS 16 // Jobs a client may keep (finished ones are forgotten first)
 
 std::atomic<bool> serverRunning(true); // Atomic flag to indicate if the server is running
-std::atomic<int> activeClients(0); // Counter for the number of currently active clients
 int serverFd; // File descriptor for the server socket
+CostModel costModel; // Predicts the solve time of each MST algorithm, used by "solve auto"
+ActiveObject computePool(defaultThreadCount(), ActiveObject::WORK_STEALING); // Solves the components of "solve forest" concurrently, one thread per core
+GraphRegistry graphRegistry; // The named graphs, shared by every client
+MSTCache mstCache(MST_CACHE_BYTES); // Solved MSTs by graph content and algorithm, shared by every client
+ActiveObject jobPool(SOLVE_JOB_THREADS); // Runs the "solve async" jobs; declared last, so its threads stop first
+
+// Function to decode a 32-bit little-endian integer of an upload record
+static int readInt32(const unsigned char *bytes)
+{
+    return static_cast<int>(static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+                            static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+// Reply to queries that need an MST when there is none yet
+const char NO_MST_REPLY[] = "MST not computed yet. Use solve command first.\n";
+
+// Reply to commands that need a graph when there is none yet
+const char NO_GRAPH_REPLY[] = "Graph is not created. Use create command first.\n";
+
+// Function to handle the "create" command: a new, empty graph, private to this client or shared under a name
+static void handleCreate(Connection &connection, Tokenizer &args, const std::string &)
+{
+    Session &session = connection.getSession();
+    OutputBuffer &out = connection.out();
+    int size = -1;
+    Token name = {"", 0};
+    Token storage = {"", 0};
+    Tokenizer numberFirst = args; // "create <vertices>" or "create <name> <vertices>"
+    if (!numberFirst.nextInt(size))
+    {
+        args.next(name);
+    }
+    if (!args.nextInt(size) || size < 0) // Read the size of the graph (number of vertices)
+    {
+        out << "Invalid vertex count. Use create [<name>] <vertices> [dense].\n";
+        return;
+    }
+    args.next(storage); // The optional storage backend
+    std::shared_ptr<Graph> graph = std::make_shared<Graph>(size, storage.is("dense") ? Graph::DENSE : Graph::SPARSE); // Adjacency matrix or edge lists
+    if (name.length > 0)
+    {
+        session.graphName = name.str();
+        session.graph = graphRegistry.open(session.graphName); // Replaces the graph of that name for every client using it
+    }
+    else if (session.graph->isShared())
+    {
+        session.graphName.clear();
+        session.graph = std::make_shared<GraphHandle>(false); // Leave the named graph alone
+    }
+    session.graph->update([&](GraphVersion &draft) {
+        draft.graph = graph;
+        draft.mst.reset(); // The old MST belongs to the old graph
+    });
+    if (name.length > 0)
+    {
+        out << "Graph " << session.graphName << " created with " << size << " vertices.\n";
+    }
+    else
+    {
+        out << "Graph created with " << size << " vertices.\n";
+    }
+}
 
-// Function to close all active client connections
-void closeAllClients()
+// Function to handle the "use" command: switch to a named graph, shared with the other clients using it
+static void handleUse(Connection &connection, Tokenizer &args, const std::string &)
 {
-    std::lock_guard<std::mutex> lock(clientSocketMutex); // Lock the mutex to ensure thread safety
-    for (int clientSocket : activeClientSockets) // Iterate through all active client sockets
+    Session &session = connection.getSession();
+    OutputBuffer &out = connection.out();
+    Token name;
+    if (!args.next(name))
+    {
+        out << "Invalid graph name. Use use <name>.\n";
+        return;
+    }
+    std::shared_ptr<GraphHandle> handle = graphRegistry.find(name.str());
+    if (!handle)
     {
-        shutdown(clientSocket, SHUT_RDWR); // Disable both reading and writing on the client socket
-        close(clientSocket); // Close the socket
-        std::cout << "Closed client socket: " << clientSocket << std::endl; // Output a message about the closed client socket
+        out << "No graph named " << name.str() << ". Use create <name> <vertices> first.\n";
+        return;
     }
-    activeClientSockets.clear(); // Clear the set of active clients
+    session.graphName = name.str();
+    session.graph = handle;
+    std::shared_ptr<const GraphVersion> version = handle->current();
+    if (!version->graph)
+    {
+        out << "Using graph " << session.graphName << ".\n"; // Its creator has not published it yet
+        return;
+    }
+    out << "Using graph " << session.graphName << " with " << version->graph->getNumberOfVertices() << " vertices and "
+        << version->graph->getNumberOfEdges() << " edges" << (version->mst ? " (MST solved).\n" : ".\n");
 }
 
-// Function to handle a single client connection
-void handleClient(int clientSocket)
+// Helper function to apply change(graph) to the edge (u, v) of the session's graph, keeping a solved MST up to
+// date. Edits in a row go to one draft (Session::edits), published once the run ends. Returns true if the MST
+// changed; totalWeight then gets its new weight
+template <typename Change>
+static bool changeEdge(Session &session, int u, int v, Change change, int &totalWeight)
 {
-    char buffer[BUFFER_SIZE] = {0}; // Buffer to store incoming client data
-    std::unique_ptr<Graph> graph;   // Pointer to store the client's graph
-    std::unique_ptr<MSTTree> mst;   // Pointer to store the client's computed MST
+    if (!session.edits)
+    {
+        session.edits.reset(new GraphHandle::Batch(*session.graph));
+    }
+    GraphVersion &draft = session.edits->draft();
+    Graph &graph = GraphHandle::writableGraph(draft); // Copied only by the first edit of the run
+    MSTTree *mst = draft.mst ? &GraphHandle::writableMst(draft) : nullptr;
+    if (mst && !mst->isDynamic())
+    {
+        mst->enableDynamicMode(graph); // From now on the MST follows every change of the graph
+    }
+    change(graph);
+    bool updated = mst && mst->onEdgeChanged(graph, u, v); // Update the MST instead of solving again
+    if (updated)
+    {
+        totalWeight = mst->getTotalWeight();
+    }
+    return updated;
+}
 
-    // Add the client socket to the set of active clients
+// Function to handle the "add" command: add an edge to the graph (or change its weight)
+static void handleAdd(Connection &connection, Tokenizer &args, const std::string &)
+{
+    Session &session = connection.getSession();
+    OutputBuffer &out = connection.out();
+    if (!session.graph->current()->graph)
+    {
+        out << NO_GRAPH_REPLY;
+        return;
+    }
+    int u = -1, v = -1, weight = 0, totalWeight = 0;
+    args.nextInt(u); // Read the vertices and the weight of the edge
+    args.nextInt(v);
+    args.nextInt(weight);
+    bool updated = changeEdge(session, u, v, [&](Graph &graph) { graph.addEdge(u, v, weight); }, totalWeight);
+    out << "Edge added: (" << u << ", " << v << ") with weight " << weight << "\n";
+    if (updated)
     {
-        std::lock_guard<std::mutex> lock(clientSocketMutex);
-        activeClientSockets.insert(clientSocket);
+        out << "MST updated: total weight " << totalWeight << "\n";
     }
+}
 
-    activeClients++; // Increment the counter of active clients
+// Function to handle the "remove" command: remove an edge from the graph
+static void handleRemove(Connection &connection, Tokenizer &args, const std::string &)
+{
+    Session &session = connection.getSession();
+    OutputBuffer &out = connection.out();
+    if (!session.graph->current()->graph)
+    {
+        out << NO_GRAPH_REPLY;
+        return;
+    }
+    int u = -1, v = -1, totalWeight = 0;
+    args.nextInt(u); // Read the vertices of the edge to be removed
+    args.nextInt(v);
+    bool updated = changeEdge(session, u, v, [&](Graph &graph) { graph.removeEdge(u, v); }, totalWeight);
+    out << "Edge removed: (" << u << ", " << v << ")\n";
+    if (updated)
+    {
+        out << "MST updated: total weight " << totalWeight << "\n";
+    }
+}
 
-    while (serverRunning)
+// Function to handle the "upload" command: a whole graph in one binary frame (see Connection.hpp), answered once
+static void handleUpload(Connection &connection, Tokenizer &args, const std::string &request)
+{
+    Session &session = connection.getSession();
+    OutputBuffer &out = connection.out();
+    long long size = 0, edgeCount = 0;
+    Token storage = {"", 0};
+    args.nextNumber(size, 1, INT_MAX); // Read the number of vertices, the number of edges and the optional storage backend
+    args.nextNumber(edgeCount, 1, MAX_UPLOAD_EDGES);
+    args.next(storage);
+    size_t payloadStart = request.find('\n') + 1; // 0 if there is no payload at all
+    if (size <= 0 || edgeCount <= 0 || payloadStart == 0 ||
+        request.size() - payloadStart != static_cast<size_t>(edgeCount) * UPLOAD_RECORD_SIZE)
     {
-        int bytesRead = read(clientSocket, buffer, BUFFER_SIZE); // Read data from the client
-        if (bytesRead <= 0) // If no data is read, or there's an error, assume the client disconnected
-        {
-            std::cout << "Client disconnected.\n";
-            break;
-        }
+        out << "Invalid upload. Send \"upload <vertices> <edges> [dense]\" followed by the edges, at most " << MAX_UPLOAD_EDGES << ".\n";
+        out.flush();
+        connection.close(); // Whatever follows cannot be told apart from the payload
+        return;
+    }
 
-        std::string request(buffer, bytesRead); // Convert the raw buffer data into a string
-        std::stringstream ss(request); // Use stringstream to process the incoming request
-        std::string command;
-        ss >> command; // Extract the first word (command) from the request
-
-        // Handle the "longest distance" command
-        if (request.find("longest distance") != std::string::npos) {
-            if (mst) { // Check if an MST is already computed
-                int longestDistance = mst->getLongestDistance(); // Get the longest distance in the MST
-                std::string response = "Longest distance in MST: " + std::to_string(longestDistance) + "\n";
-                send(clientSocket, response.c_str(), response.size(), 0); // Send the response to the client
-            } else {
-                std::string response = "MST not computed yet. Use solve command first.\n";
-                send(clientSocket, response.c_str(), response.size(), 0); // Inform the client that the MST isn't computed yet
-            }
-            continue; // Move to the next iteration
-        }
+    EdgeList &edges = SolverWorkspace::local().edges(edgeCount); // Decoded edges, in a buffer this thread keeps
+    const unsigned char *record = reinterpret_cast<const unsigned char *>(request.data()) + payloadStart;
+    for (long long i = 0; i < edgeCount; ++i, record += UPLOAD_RECORD_SIZE)
+    {
+        edges.push(readInt32(record), readInt32(record + 4), readInt32(record + 8));
+    }
+    std::shared_ptr<Graph> graph = std::make_shared<Graph>(static_cast<int>(size), storage.is("dense") ? Graph::DENSE : Graph::SPARSE);
+    size_t accepted = graph->addEdges(edges);
+    session.graph->update([&](GraphVersion &draft) {
+        draft.graph = graph;
+        draft.mst.reset(); // The old MST belongs to the old graph
+    });
+    out << "Graph uploaded with " << size << " vertices and " << graph->getNumberOfEdges() << " edges ("
+        << edgeCount - static_cast<long long>(accepted) << " invalid records skipped).\n";
+}
 
-        // Handle the "avg distance" command
-        if (request.find("avg distance") != std::string::npos) {
-            if (mst) {
-                double averageDistance = mst->getAverageDistance(); // Compute the average distance of edges in the MST
-                std::string response = "Average distance in MST: " + std::to_string(averageDistance) + "\n";
-                send(clientSocket, response.c_str(), response.size(), 0);
-            } else {
-                std::string response = "MST not computed yet. Use solve command first.\n";
-                send(clientSocket, response.c_str(), response.size(), 0);
+// Helper function to fill in the algorithm of job from the arguments of "solve" (Prim, Kruskal, Borůvka,
+// Filter-Kruskal, auto or forest); job->algo stays null for an unknown one
+static void chooseAlgorithm(Tokenizer &args, SolveJob &job)
+{
+    const Graph &graph = *job.version->graph;
+    Token algorithm = {"", 0};
+    args.next(algorithm);
+    if (algorithm.is("forest"))
+    {
+        // Solve every connected component on its own, concurrently, with the algorithm that follows (Kruskal by default)
+        job.forest = true;
+        Token componentAlgorithm = {"kruskal", 7};
+        args.next(componentAlgorithm);
+        args.nextInt(job.threads); // Optional thread count for the labeling and the parallel algorithms
+        for (int t = 0; t < MSTFactory::ALGORITHM_COUNT; ++t)
+        {
+            const char *name = MSTFactory::algorithmName(static_cast<MSTFactory::AlgorithmType>(t));
+            if (componentAlgorithm.length == std::strlen(name) && std::memcmp(componentAlgorithm.data, name, componentAlgorithm.length) == 0)
+            {
+                job.type = static_cast<MSTFactory::AlgorithmType>(t);
+                job.algo.reset(new SpanningForest(job.type, computePool, job.threads));
             }
-            continue;
         }
+    }
+    else if (algorithm.is("prim"))
+    {
+        job.algo.reset(MSTFactory::createMSTAlgorithm(MSTFactory::PRIM)); // Use Prim's algorithm
+    }
+    else if (algorithm.is("kruskal"))
+    {
+        job.type = MSTFactory::KRUSKAL;
+        job.algo.reset(MSTFactory::createMSTAlgorithm(MSTFactory::KRUSKAL)); // Use Kruskal's algorithm
+    }
+    else if (algorithm.is("boruvka"))
+    {
+        job.type = MSTFactory::BORUVKA;
+        args.nextInt(job.threads); // Optional thread count, defaults to one per core
+        job.algo.reset(MSTFactory::createMSTAlgorithm(MSTFactory::BORUVKA, job.threads)); // Use parallel Borůvka
+    }
+    else if (algorithm.is("filter-kruskal"))
+    {
+        job.type = MSTFactory::FILTER_KRUSKAL;
+        args.nextInt(job.threads); // Optional thread count, defaults to one per core
+        job.algo.reset(MSTFactory::createMSTAlgorithm(MSTFactory::FILTER_KRUSKAL, job.threads)); // Use parallel Filter-Kruskal
+    }
+    else if (algorithm.is("auto"))
+    {
+        // Let the calibrated cost model pick the algorithm expected to be fastest for this graph
+        job.automatic = true;
+        job.type = costModel.choose(graph.getNumberOfVertices(), graph.getNumberOfEdges(), job.predictedMs);
+        job.algo.reset(MSTFactory::createMSTAlgorithm(job.type));
+    }
+}
 
-        // Handle the "shortest distance" command
-        if (request.find("shortest distance") != std::string::npos) {
-            int u, v;
-            ss >> u >> v; // Read the two vertices for which the shortest distance is requested
-            if (mst && u >= 0 && v >= 0 && u < graph->getNumberOfVertices() && v < graph->getNumberOfVertices()) {
-                int shortestDistance = mst->getShortestDistance(u, v); // Calculate the shortest distance between two vertices in the MST
-                std::string response;
-                if (shortestDistance == -1) {
-                    response = "No path exists between vertices " + std::to_string(u) + " and " + std::to_string(v) + ".\n";
-                } else {
-                    response = "Shortest distance between " + std::to_string(u) + " and " + std::to_string(v) + " in MST: " + std::to_string(shortestDistance) + "\n";
-                }
-                send(clientSocket, response.c_str(), response.size(), 0);
-            } else {
-                std::string response = "Invalid vertex indices or MST not computed yet. Use solve command first.\n";
-                send(clientSocket, response.c_str(), response.size(), 0);
-            }
-            continue;
+// Helper function to run a started job: take the MST from the cache of solved MSTs, or compute it (a new tree
+// has no memoized metrics yet) and cache it; then publish it along with the graph. Returns false if the job
+// was cancelled before the MST was complete
+static bool runSolve(SolveJob &job)
+{
+    const Graph &graph = *job.version->graph;
+    int cacheAlgorithm = job.forest ? MSTFactory::ALGORITHM_COUNT + job.type : job.type; // A forest's tree has its components summarized
+    auto start = std::chrono::steady_clock::now();
+    job.mst = mstCache.find(graph, cacheAlgorithm);
+    job.cached = (job.mst != nullptr);
+    if (!job.cached)
+    {
+        job.algo->setCancelFlag(job.getCancelFlag());
+        std::shared_ptr<MSTTree> mst = std::make_shared<MSTTree>(job.algo->computeMST(graph));
+        if (*job.getCancelFlag())
+        {
+            return false; // Possibly a partial tree
+        }
+        job.mst = mst;
+        mstCache.insert(job.version->graph, cacheAlgorithm, mst); // A published graph, never changed again
+    }
+    job.actualMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    job.graph->update([&](GraphVersion &draft) {
+        job.kept = (draft.graph == job.version->graph); // Another client may have changed a shared graph meanwhile
+        if (job.kept)
+        {
+            draft.mst = job.mst;
         }
+    });
+    if (job.threads == 0 && !job.forest && !job.cached)
+    {
+        costModel.observe(job.type, graph.getNumberOfVertices(), graph.getNumberOfEdges(), job.actualMs); // Refine the model with the real time
+    }
+    return true;
+}
+
+// Helper function to send the MST of a job that is DONE: its edges and total weight. The edge list streams
+// out as it is written, so even the MST of a huge graph only ever holds OutputBuffer::HIGH_WATER_MARK bytes of it
+static void reportSolve(OutputBuffer &out, const SolveJob &job)
+{
+    const MSTTree &mst = *job.mst;
+    out << "Following are the edges in the constructed MST:\n";
+    for (const auto &edge : mst.getEdges())
+    {
+        out << edge.u << " -- " << edge.v << " == " << edge.weight << "\n"; // The tree's own weight: no lookup in the graph
+    }
+    if (job.forest)
+    {
+        out << "Minimum Cost Spanning Forest: " << mst.getTotalWeight() << " (" << mst.getComponents().size() << " components)"
+            << (job.cached ? " (cached)\n" : "\n");
+    }
+    else
+    {
+        out << "Minimum Cost Spanning Tree: " << mst.getTotalWeight() << (job.cached ? " (cached)\n" : "\n");
+    }
+    if (!job.kept)
+    {
+        out << "The graph changed while it was being solved; this MST was not kept.\n";
+    }
+    if (job.automatic)
+    {
+        out << "Algorithm selected: " << MSTFactory::algorithmName(job.type) << " (predicted " << job.predictedMs << " ms, actual " << job.actualMs << " ms)\n";
+    }
+}
+
+// Helper function to make room for a new job in the session: the oldest finished jobs are forgotten once
+// MAX_SOLVE_JOBS are kept. Returns false if that many are still queued or running
+static bool makeRoomForJob(Session &session)
+{
+    for (auto it = session.jobs.begin(); it != session.jobs.end() && session.jobs.size() >= MAX_SOLVE_JOBS;)
+    {
+        SolveJob::State state = it->second->getState();
+        it = (state == SolveJob::DONE || state == SolveJob::CANCELLED) ? session.jobs.erase(it) : std::next(it);
+    }
+    return session.jobs.size() < MAX_SOLVE_JOBS;
+}
+
+// Function to handle the "solve" command: pick the algorithm, compute the MST, then report it. With "async"
+// the MST is computed on jobPool instead and the reply is the job's id, for "status", "wait" and "cancel"
+static void handleSolve(Connection &connection, Tokenizer &args, const std::string &)
+{
+    Session &session = connection.getSession();
+    OutputBuffer &out = connection.out();
+    std::shared_ptr<SolveJob> job = std::make_shared<SolveJob>();
+    job->graph = session.graph;
+    job->version = session.graph->current(); // The graph as it is now, whatever changes meanwhile
+    if (!job->version->graph)
+    {
+        out << NO_GRAPH_REPLY;
+        return;
+    }
+    Tokenizer afterAsync = args;
+    Token word = {"", 0};
+    bool async = afterAsync.next(word) && word.is("async");
+    if (async)
+    {
+        args = afterAsync;
+    }
+    int jobId = 0;
+
+    Pipeline pipeline;
 
-        // Create a pipeline to handle multiple steps in sequence
-        Pipeline pipeline;
+    // Step 1: choose the algorithm
+    pipeline.addStep([&]() {
+        chooseAlgorithm(args, *job);
+    });
 
-        // Handle the "create" command to create a new graph
-        if (command == "create")
+    // Step 2: compute the MST here, or queue it on the job pool
+    pipeline.addStep([&]() {
+        if (!job->algo)
+        {
+            return;
+        }
+        if (!async)
         {
-            pipeline.addStep([&](){
-                int size;
-                ss >> size; // Read the size of the graph (number of vertices)
-                graph = std::make_unique<Graph>(size); // Create a new graph
-                std::string response = "Graph created with " + std::to_string(size) + " vertices.\n";
-                send(clientSocket, response.c_str(), response.size(), 0); // Send response back to the client
-            });
+            job->start();
+            job->finish(runSolve(*job));
+            return;
         }
-        // Handle the "add" command to add an edge to the graph
-        else if (command == "add")
+        if (!makeRoomForJob(session))
         {
-            pipeline.addStep([&](){
-                if (!graph)
-                {
-                    std::string response = "Graph is not created. Use create command first.\n";
-                    send(clientSocket, response.c_str(), response.size(), 0);
-                    return;
-                }
-                int u, v, weight;
-                ss >> u >> v >> weight; // Read the vertices and the weight of the edge
-                graph->addEdge(u, v, weight); // Add the edge to the graph
-                std::string response = "Edge added: (" + std::to_string(u) + ", " + std::to_string(v) + ") with weight " + std::to_string(weight) + "\n";
-                send(clientSocket, response.c_str(), response.size(), 0);
-            });
+            return;
         }
-        // Handle the "remove" command to remove an edge from the graph
-        else if (command == "remove")
+        jobId = session.nextJobId++;
+        session.jobs[jobId] = job;
+        jobPool.enqueueTask([job]() {
+            if (job->start()) // Not cancelled while it was queued
+            {
+                job->finish(runSolve(*job));
+            }
+        });
+    });
+
+    // Step 3: report the MST, or the job
+    pipeline.addStep([&]() {
+        if (!job->algo)
         {
-            pipeline.addStep([&](){
-                if (!graph)
-                {
-                    std::string response = "Graph is not created. Use create command first.\n";
-                    send(clientSocket, response.c_str(), response.size(), 0);
-                    return;
-                }
-                int u, v;
-                ss >> u >> v; // Read the vertices of the edge to be removed
-                graph->removeEdge(u, v); // Remove the edge from the graph
-                std::string response = "Edge removed: (" + std::to_string(u) + ", " + std::to_string(v) + ")\n";
-                send(clientSocket, response.c_str(), response.size(), 0);
-            });
+            out << "Unknown algorithm requested.\n";
         }
-        // Handle the "solve" command to compute the MST
-        else if (command == "solve")
+        else if (!async)
         {
-            pipeline.addStep([&](){
-                if (!graph)
-                {
-                    std::string response = "Graph is not created. Use create command first.\n";
-                    send(clientSocket, response.c_str(), response.size(), 0);
-                    return;
-                }
-
-                std::string algorithm;
-                ss >> algorithm; // Read which algorithm to use (Prim or Kruskal)
-                MSTAlgo* algo = nullptr;
-
-                if (algorithm == "prim")
-                {
-                    algo = MSTFactory::createMSTAlgorithm(MSTFactory::PRIM); // Use Prim's algorithm
-                }
-                else if (algorithm == "kruskal")
-                {
-                    algo = MSTFactory::createMSTAlgorithm(MSTFactory::KRUSKAL); // Use Kruskal's algorithm
-                }
-
-                if (algo)
-                {
-                    mst = std::make_unique<MSTTree>(algo->computeMST(*graph)); // Compute the MST
-
-                    // Construct the response string to send to the client
-                    std::vector<std::pair<int, int>> mstEdges = mst->getEdges();
-                    std::string response = "Following are the edges in the constructed MST:\n";
-                    for (const auto& edge : mstEdges) {
-                        int u = edge.first;
-                        int v = edge.second;
-                        int weight = graph->getAdjacencyMatrix()[u][v]; // Get the weight of each edge
-                        response += std::to_string(u) + " -- " + std::to_string(v) + " == " + std::to_string(weight) + "\n";
-                    }
-
-                    // Append the total weight to the response
-                    int totalWeight = mst->getTotalWeight();
-                    response += "Minimum Cost Spanning Tree: " + std::to_string(totalWeight) + "\n";
-
-                    // Send the response to the client
-                    send(clientSocket, response.c_str(), response.size(), 0);
-
-                    // Clean up the algorithm object
-                    delete algo;
-                }
-                else
-                {
-                    std::string response = "Unknown algorithm requested.\n";
-                    send(clientSocket, response.c_str(), response.size(), 0);
-                }
-            });
+            reportSolve(out, *job);
         }
-        // Handle the "shutdown" command to shut down a client
-        else if (command == "shutdown")
+        else if (jobId == 0)
         {
-            pipeline.addStep([&](){
-                std::string response = "Shutting down this client.\n";
-                send(clientSocket, response.c_str(), response.size(), 0);
-                std::cout << "Client initiated shutdown command.\n";
-
-                // Close only this client's connection
-                close(clientSocket); // Close the client's socket
-                {
-                    std::lock_guard<std::mutex> lock(clientSocketMutex);
-                    activeClientSockets.erase(clientSocket); // Remove this client from the active set
-                }
-
-                activeClients--; // Decrease the active client count
-                return; // Exit the loop for this client
-            });
+            out << "Too many solve jobs (" << MAX_SOLVE_JOBS << "). Wait for or cancel one first.\n";
         }
         else
         {
-            pipeline.addStep([&](){
-                std::string response = "Unknown command.\n";
-                send(clientSocket, response.c_str(), response.size(), 0); // Inform the client that the command is unknown
-            });
+            out << "Job " << jobId << " queued: solve " << (job->forest ? "forest " : "") << MSTFactory::algorithmName(job->type) << "\n";
         }
+    });
+
+    pipeline.execute();
+}
 
-        // Execute all steps in the pipeline for this command
-        pipeline.execute();
+// Helper function to read the job id of "status", "wait" and "cancel" and find the job; replies and returns
+// null if there is no such job
+static std::shared_ptr<SolveJob> findJob(Connection &connection, Tokenizer &args, int &jobId)
+{
+    Session &session = connection.getSession();
+    args.nextInt(jobId);
+    auto it = session.jobs.find(jobId);
+    if (it == session.jobs.end())
+    {
+        connection.out() << "No job " << jobId << ". Use solve async <algorithm> to start one.\n";
+        return nullptr;
     }
+    return it->second;
+}
 
-    // Ensure that the client is removed from the active set and its socket is closed if not done earlier
+// Helper function to report the progress of a job in the given state, and its result once it is done
+static void reportStatus(OutputBuffer &out, int jobId, const SolveJob &job, SolveJob::State state)
+{
+    switch (state)
     {
-        std::lock_guard<std::mutex> lock(clientSocketMutex);
-        activeClientSockets.erase(clientSocket); // Remove the client from the active set
+    case SolveJob::QUEUED:
+        out << "Job " << jobId << ": queued for " << job.getAgeMs() << " ms\n";
+        break;
+    case SolveJob::RUNNING:
+        out << "Job " << jobId << ": running for " << job.getAgeMs() << " ms\n";
+        break;
+    case SolveJob::DONE:
+        out << "Job " << jobId << ": done in " << job.actualMs << " ms, total weight " << job.mst->getTotalWeight() << "\n";
+        break;
+    case SolveJob::CANCELLED:
+        out << "Job " << jobId << ": cancelled\n";
+        break;
     }
+}
 
-    close(clientSocket); // Close the client's socket
-    std::cout << "Client socket closed.\n"; // Log the closure
+// Function to handle the "status" command: the progress of a job, and its result once it is done
+static void handleStatus(Connection &connection, Tokenizer &args, const std::string &)
+{
+    int jobId = 0;
+    std::shared_ptr<SolveJob> job = findJob(connection, args, jobId);
+    if (job)
+    {
+        reportStatus(connection.out(), jobId, *job, job->getState());
+    }
 }
 
-// Main server function using the Leader-Follower pattern
-void runServer()
+// Helper function to answer a "wait" once its job is done or its timeout passed: report the MST like "solve"
+// does and forget the job, or report a job that is still unfinished like "status" does
+static void finishWait(Connection &connection, int jobId, const SolveJob &job)
+{
+    OutputBuffer &out = connection.out();
+    SolveJob::State state = job.getState();
+    if (state == SolveJob::DONE)
+    {
+        reportSolve(out, job);
+    }
+    else
+    {
+        reportStatus(out, jobId, job, state);
+    }
+    if (state == SolveJob::DONE || state == SolveJob::CANCELLED)
+    {
+        connection.getSession().jobs.erase(jobId);
+    }
+}
+
+// Function to handle the "wait" command: answer once the job is done, or once the optional timeout in
+// milliseconds passed. No thread waits: the connection is suspended and its next commands wait meanwhile
+static void handleWait(Connection &connection, Tokenizer &args, const std::string &)
+{
+    int jobId = 0;
+    std::shared_ptr<SolveJob> job = findJob(connection, args, jobId);
+    if (!job)
+    {
+        return;
+    }
+    long long timeoutMs = -1; // None
+    args.nextNumber(timeoutMs, 0);
+    job->whenDone(connection.suspend([jobId, job](Connection &client)
+                                     { finishWait(client, jobId, *job); },
+                                     timeoutMs));
+}
+
+// Function to handle the "cancel" command: stop a job
+static void handleCancel(Connection &connection, Tokenizer &args, const std::string &)
+{
+    OutputBuffer &out = connection.out();
+    int jobId = 0;
+    std::shared_ptr<SolveJob> job = findJob(connection, args, jobId);
+    if (!job)
+    {
+        return;
+    }
+    job->cancel();
+    switch (job->getState())
+    {
+    case SolveJob::DONE:
+        out << "Job " << jobId << ": already done\n";
+        break;
+    case SolveJob::CANCELLED:
+        out << "Job " << jobId << ": cancelled\n";
+        break;
+    default:
+        out << "Job " << jobId << ": cancelling\n"; // The algorithm stops at its next cancellation point
+        break;
+    }
+}
+
+// Function to handle the "longest distance" command
+static void handleLongestDistance(Connection &connection, Tokenizer &, const std::string &)
+{
+    std::shared_ptr<const GraphVersion> version = connection.getSession().graph->current();
+    const std::shared_ptr<MSTTree> &mst = version->mst;
+    OutputBuffer &out = connection.out();
+    if (!mst)
+    {
+        out << NO_MST_REPLY;
+        return;
+    }
+    bool cached = mst->isLongestDistanceCached(); // Whether this answer comes from the MST's cache
+    out << "Longest distance in MST: " << mst->getLongestDistance() << (cached ? " (cached)" : "") << "\n";
+}
+
+// Function to handle the "avg distance" command
+static void handleAvgDistance(Connection &connection, Tokenizer &, const std::string &)
+{
+    std::shared_ptr<const GraphVersion> version = connection.getSession().graph->current();
+    const std::shared_ptr<MSTTree> &mst = version->mst;
+    OutputBuffer &out = connection.out();
+    if (!mst)
+    {
+        out << NO_MST_REPLY;
+        return;
+    }
+    bool cached = mst->isAverageDistanceCached();
+    out << "Average distance in MST: " << mst->getAverageDistance() << (cached ? " (cached)" : "") << "\n";
+}
+
+// Function to handle the "shortest distance" command
+static void handleShortestDistance(Connection &connection, Tokenizer &args, const std::string &)
+{
+    std::shared_ptr<const GraphVersion> version = connection.getSession().graph->current();
+    OutputBuffer &out = connection.out();
+    int u = -1, v = -1;
+    args.nextInt(u); // Read the two vertices for which the shortest distance is requested
+    args.nextInt(v);
+    if (!version->mst || u < 0 || v < 0 || u >= version->graph->getNumberOfVertices() || v >= version->graph->getNumberOfVertices())
+    {
+        out << "Invalid vertex indices or MST not computed yet. Use solve command first.\n";
+        return;
+    }
+    bool cached = version->mst->isDistanceIndexBuilt(); // The distance index is built by the first query and then reused
+    int shortestDistance = version->mst->getShortestDistance(u, v);
+    if (shortestDistance == -1)
+    {
+        out << "No path exists between vertices " << u << " and " << v << ".\n";
+    }
+    else
+    {
+        out << "Shortest distance between " << u << " and " << v << " in MST: " << shortestDistance << (cached ? " (cached)" : "") << "\n";
+    }
+}
+
+// Function to handle the "batch" command: several queries in one request, answered in order in one response
+static void handleBatch(Connection &connection, Tokenizer &args, const std::string &)
+{
+    std::shared_ptr<const GraphVersion> version = connection.getSession().graph->current();
+    const std::shared_ptr<MSTTree> &mst = version->mst;
+    OutputBuffer &out = connection.out();
+    if (!mst)
+    {
+        out << NO_MST_REPLY;
+        return;
+    }
+
+    enum Query { LONGEST, AVG, WEIGHT, COMPONENTS, DISTANCE };
+    std::vector<Query> queries; // The queries in order; each DISTANCE stands for the next entry of pairs
+    std::vector<std::pair<int, int>> pairs;
+    Token query;
+    while (args.next(query))
+    {
+        if (query.is("distance"))
+        {
+            int u = -1, v = -1;
+            args.nextInt(u); // Read the two vertices
+            args.nextInt(v);
+            pairs.emplace_back(u, v);
+            queries.push_back(DISTANCE);
+        }
+        else if (query.is("longest") || query.is("avg") || query.is("weight") || query.is("components"))
+        {
+            queries.push_back(query.is("longest") ? LONGEST : query.is("avg") ? AVG : query.is("weight") ? WEIGHT : COMPONENTS);
+        }
+        else
+        {
+            out << "Invalid batch query: ";
+            out.append(query.data, query.length);
+            out << ". Use longest, avg, weight, components or distance <u> <v>.\n";
+            return;
+        }
+    }
+
+    std::vector<long long> distances;
+    mst->getShortestDistances(pairs, distances, defaultThreadCount()); // Every pair in one pass
+    out << "Batch of " << queries.size() << " queries:\n";
+    size_t nextPair = 0;
+    for (Query kind : queries)
+    {
+        switch (kind)
+        {
+        case LONGEST:
+            out << "Longest distance in MST: " << mst->getLongestDistance() << "\n";
+            break;
+        case AVG:
+            out << "Average distance in MST: " << mst->getAverageDistance() << "\n";
+            break;
+        case WEIGHT:
+            out << "Total weight of MST: " << mst->getTotalWeight() << "\n";
+            break;
+        case COMPONENTS:
+            out << "Components in MST: " << mst->getComponents().size() << "\n";
+            break;
+        case DISTANCE:
+        {
+            const std::pair<int, int> &pair = pairs[nextPair];
+            long long distance = distances[nextPair++];
+            if (distance == -1)
+            {
+                out << "No path exists between vertices " << pair.first << " and " << pair.second << ".\n";
+            }
+            else
+            {
+                out << "Shortest distance between " << pair.first << " and " << pair.second << " in MST: " << distance << "\n";
+            }
+            break;
+        }
+        }
+    }
+}
+
+// Function to handle the "distances" command: a batch of vertex pairs in one binary frame (see Connection.hpp), answered in one line
+static void handleDistances(Connection &connection, Tokenizer &args, const std::string &request)
+{
+    std::shared_ptr<const GraphVersion> version = connection.getSession().graph->current();
+    const std::shared_ptr<MSTTree> &mst = version->mst;
+    OutputBuffer &out = connection.out();
+    long long pairCount = 0;
+    args.nextNumber(pairCount, 1, MAX_BATCH_PAIRS); // Read the number of pairs
+    size_t payloadStart = request.find('\n') + 1; // 0 if there is no payload at all
+    if (pairCount <= 0 || payloadStart == 0 || request.size() - payloadStart != static_cast<size_t>(pairCount) * PAIR_RECORD_SIZE)
+    {
+        out << "Invalid distance batch. Send \"distances <pairs>\" followed by the pairs, at most " << MAX_BATCH_PAIRS << ".\n";
+        out.flush();
+        connection.close(); // Whatever follows cannot be told apart from the payload
+        return;
+    }
+    if (!mst)
+    {
+        out << NO_MST_REPLY;
+        return;
+    }
+
+    std::vector<std::pair<int, int>> pairs(pairCount);
+    const unsigned char *record = reinterpret_cast<const unsigned char *>(request.data()) + payloadStart;
+    for (std::pair<int, int> &pair : pairs)
+    {
+        pair = {readInt32(record), readInt32(record + 4)};
+        record += PAIR_RECORD_SIZE;
+    }
+    std::vector<long long> distances;
+    mst->getShortestDistances(pairs, distances, defaultThreadCount());
+    out << "Shortest distances in MST (" << pairCount << " pairs):";
+    for (long long distance : distances)
+    {
+        out << ' ' << distance; // Streams out while the rest is formatted
+    }
+    out << '\n';
+}
+
+// Function to handle the "components" command: one summary per tree of the forest
+static void handleComponents(Connection &connection, Tokenizer &, const std::string &)
+{
+    std::shared_ptr<const GraphVersion> version = connection.getSession().graph->current();
+    const std::shared_ptr<MSTTree> &mst = version->mst;
+    OutputBuffer &out = connection.out();
+    if (!mst)
+    {
+        out << NO_MST_REPLY;
+        return;
+    }
+    bool cached = mst->isComponentsCached();
+    const std::vector<MSTTree::Component> &components = mst->getComponents();
+    out << "Components in MST: " << components.size() << (cached ? " (cached)" : "") << "\n";
+    for (const MSTTree::Component &component : components)
+    {
+        out << "Component of vertex " << component.representative << ": " << component.vertices << " vertices, weight "
+            << component.weight << ", diameter " << component.diameter << "\n";
+    }
+}
+
+// Function to handle the "workspace" command: how often the solver scratch buffers had to grow (0 new ones once warmed up)
+static void handleWorkspace(Connection &connection, Tokenizer &, const std::string &)
+{
+    const SolverWorkspace &workspace = SolverWorkspace::local(); // Solves of this connection run on this thread
+    connection.out() << "Solver workspace of this connection: " << workspace.getAllocations() << " allocations over " << workspace.getRuns() << " runs\n"
+                     << "All solver workspaces: " << SolverWorkspace::getTotalAllocations() << " allocations over " << SolverWorkspace::getTotalRuns() << " runs\n";
+}
+
+// Function to handle the "cache" command: how well the cache of solved MSTs does and how much it holds
+static void handleCache(Connection &connection, Tokenizer &, const std::string &)
+{
+    MSTCache::Stats stats = mstCache.getStats();
+    long long lookups = stats.hits + stats.misses;
+    connection.out() << "MST cache: " << stats.hits << " hits, " << stats.misses << " misses (hit rate "
+                     << (lookups == 0 ? 0.0 : 100.0 * stats.hits / lookups) << "%), " << stats.entries << " entries, "
+                     << stats.bytes << " of " << stats.maxBytes << " bytes, " << stats.evictions << " evictions\n";
+}
+
+// Function to handle the "shutdown" command: disconnect this client
+static void handleShutdown(Connection &connection, Tokenizer &, const std::string &)
+{
+    connection.out() << "Shutting down this client.\n";
+    connection.out().flush();
+    std::cout << "Client initiated shutdown command.\n";
+    connection.close(); // Close only this client's connection; the server drops it once the socket is shut down
+}
+
+// Function to answer a request that is not a command
+static void handleUnknown(Connection &connection, Tokenizer &, const std::string &)
+{
+    connection.out() << "Unknown command.\n";
+}
+
+// Handler of each command, indexed by CommandId
+typedef void (*CommandFunction)(Connection &connection, Tokenizer &args, const std::string &request);
+const CommandFunction COMMAND_TABLE[CMD_UNKNOWN + 1] = {
+    handleCreate,           // CMD_CREATE
+    handleUse,              // CMD_USE
+    handleAdd,              // CMD_ADD
+    handleRemove,           // CMD_REMOVE
+    handleUpload,           // CMD_UPLOAD
+    handleSolve,            // CMD_SOLVE
+    handleLongestDistance,  // CMD_LONGEST_DISTANCE
+    handleAvgDistance,      // CMD_AVG_DISTANCE
+    handleShortestDistance, // CMD_SHORTEST_DISTANCE
+    handleBatch,            // CMD_BATCH
+    handleDistances,        // CMD_DISTANCES
+    handleComponents,       // CMD_COMPONENTS
+    handleWorkspace,        // CMD_WORKSPACE
+    handleCache,            // CMD_CACHE
+    handleStatus,           // CMD_STATUS
+    handleWait,             // CMD_WAIT
+    handleCancel,           // CMD_CANCEL
+    handleShutdown,         // CMD_SHUTDOWN
+    handleUnknown,          // CMD_UNKNOWN
+};
+
+// Function to handle one command of a client, on a worker thread. Commands of the same client never run
+// concurrently, so its session needs no locking (named graphs in it are versioned, see GraphHandle). The command line is tokenized in place (the payload of a
+// binary frame after it is left alone) and its name picks the handler from COMMAND_TABLE
+void handleCommand(Connection &connection, const std::string &request)
+{
+    size_t lineEnd = std::min(request.find('\n'), request.size());
+    Tokenizer args(request.data(), lineEnd);
+    CommandId command = parseCommand(args);
+    if (command != CMD_ADD && command != CMD_REMOVE)
+    {
+        connection.getSession().publishEdits(); // Every other command sees the edits before it
+    }
+    COMMAND_TABLE[command](connection, args, request);
+}
+
+// Main server function. By default THREAD_POOL_SIZE threads take turns as leader on one epoll handle set and
+// run the commands of the events they take (Leader-Follower). With useReactor, this thread owns every socket
+// instead and hands the commands to THREAD_POOL_SIZE ActiveObject workers
+void runServer(bool useReactor)
 {
     struct sockaddr_in address; // Structure for socket address
     int opt = 1; // Option for setting socket options
-    int addrlen = sizeof(address); // Length of the address
-    int newSocket; // Socket for new client connections
 
-    // Create an ActiveObject with a thread pool of THREAD_POOL_SIZE
-    ActiveObject activeObject(THREAD_POOL_SIZE);
+    // Measure this machine once, so "solve auto" can predict the solve time of every algorithm
+    costModel.calibrate();
+    std::cout << "Cost model calibrated." << std::endl;
 
     if ((serverFd = socket(AF_INET, SOCK_STREAM, 0)) == 0) // Create the server socket
     {
@@ -296,7 +844,7 @@ void runServer()
         exit(EXIT_FAILURE);
     }
 
-    if (listen(serverFd, 10) < 0) // Start listening for client connections
+    if (listen(serverFd, SOMAXCONN) < 0) // Start listening for client connections
     {
         perror("Listen failed"); // Print error if listening fails
         exit(EXIT_FAILURE);
@@ -304,101 +852,63 @@ void runServer()
 
     std::cout << "Server is running and listening on port " << PORT << std::endl; // Print server start message
 
-    // Create a thread pool for handling client requests
-    std::vector<std::thread> threadPool;
-    for (int i = 0; i < THREAD_POOL_SIZE; ++i)
+    // Build the server before the console thread can stop it
+    std::unique_ptr<ActiveObject> activeObject;     // Workers running the clients' commands for the reactor
+    std::unique_ptr<Reactor> reactor;               // Event loop of the reactor, if chosen
+    std::unique_ptr<LeaderFollower> leaderFollower; // Else the Leader-Follower thread pool
+    std::function<void()> stopServer;               // Stops whichever server runs
+    if (useReactor)
     {
-        threadPool.emplace_back([&](){
-            while (serverRunning) // While the server is running
-            {
-                int clientSocket;
-
-                // Leader-Follower mechanism: One thread acts as the leader and processes new connections
-                {
-                    std::unique_lock<std::mutex> lock(leaderMutex);
-                    leaderCV.wait(lock, [&]() { return !clientQueue.empty() || !serverRunning; }); // Wait for new connections
-
-                    if (!serverRunning) // If the server is shutting down, exit the loop
-                    {
-                        return;
-                    }
-
-                    if (!clientQueue.empty()) // If there are client connections waiting
-                    {
-                        clientSocket = clientQueue.front(); // Get the next client socket
-                        clientQueue.pop(); // Remove it from the queue
-                    }
-                }
-
-                // Process client requests asynchronously using the ActiveObject pattern
-                activeObject.enqueueTask([clientSocket]() {
-                    handleClient(clientSocket); // Handle the client in a separate task
-                });
-            }
-        });
+        // Create an ActiveObject with a thread pool of THREAD_POOL_SIZE to run the clients' commands
+        activeObject.reset(new ActiveObject(THREAD_POOL_SIZE));
+
+        // Event loop owning the listening socket and every client socket; complete commands go to the workers
+        reactor.reset(new Reactor(serverFd, *activeObject, handleCommand));
+        stopServer = [&reactor]() { reactor->stop(); };
+    }
+    else
+    {
+        leaderFollower.reset(new LeaderFollower(serverFd, THREAD_POOL_SIZE, handleCommand));
+        stopServer = [&leaderFollower]() { leaderFollower->stop(); };
     }
 
     // Thread to listen for a shutdown command from the server console
     std::thread shutdownThread([&](){
         std::string input;
-        while (serverRunning) // While the server is running
+        while (serverRunning && std::cin >> input) // While the server is running and the console is open
         {
-            std::cin >> input; // Wait for user input in the console
             if (input == "shutdown") // If the input is "shutdown"
             {
                 std::cout << "Server shutting down...\n"; // Print shutdown message
                 serverRunning = false;  // Set the server running flag to false
-
-                // Shut down the server socket to stop accepting new connections
-                shutdown(serverFd, SHUT_RDWR); // Disable read/write operations on the server socket
-                close(serverFd);  // Close the server socket
-
-                closeAllClients(); // Close all active client connections
-
-                leaderCV.notify_all();  // Wake up all waiting threads to stop
+                stopServer(); // Stop the server, which disconnects every client
                 break;
             }
         }
     });
 
-    // Main loop to accept new client connections
-    while (serverRunning)
+    if (reactor)
     {
-        newSocket = accept(serverFd, (struct sockaddr *)&address, (socklen_t *)&addrlen); // Accept a new client connection
-
-        if (newSocket >= 0) // If a new client is connected
-        {
-            std::cout << "New client connection accepted.\n"; // Print message about new client
-            {
-                std::lock_guard<std::mutex> lock(leaderMutex);
-                clientQueue.push(newSocket); // Add the client socket to the queue
-            }
-            leaderCV.notify_one(); // Notify a thread to handle this client
-        }
-        else if (!serverRunning) // If the server is shutting down
-        {
-            break; // Exit the loop
-        }
+        reactor->run();
+        activeObject->shutdown(); // Let the running commands finish while the reactor still exists
     }
+    else
+    {
+        leaderFollower->run();
+    }
+    close(serverFd); // Stop accepting new connections
 
     // Wait for the shutdown thread to finish
     shutdownThread.join();
 
-    // Join all threads to ensure they finish gracefully
-    for (auto &th : threadPool)
-    {
-        if (th.joinable()) // If the thread can be joined
-        {
-            th.join(); // Wait for it to finish
-        }
-    }
-
     std::cout << "Server has shut down immediately.\n"; // Print shutdown message
 }
 
-// Main function to start the server
-int main()
+// Main function to start the server; "--reactor" selects the reactor with worker threads instead of Leader-Follower
+int main(int argc, char *argv[])
 {
-    runServer(); // Start the server using the Leader-Follower pattern
+    bool useReactor = argc > 1 && std::string(argv[1]) == "--reactor";
+    parallelPool() = &computePool; // Every parallel loop of the solvers and queries runs on the compute pool
+    runServer(useReactor); // Start the server
     return 0; // Return 0 to indicate successful execution
 }
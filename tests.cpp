@@ -0,0 +1,193 @@
+// Contributors: Wasim Shebalny, Shifaa Khatib.
+// Regression tests. Build and run with `make test`; exits with 1 if any check fails.
+#include "Connection.hpp"
+#include "MST_algo.hpp"
+#include "MSTCache.hpp"
+#include "Parallel.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int failures = 0; // Number of failed checks
+
+// Function to record one check
+static void check(bool passed, const char *what)
+{
+    std::printf("%s: %s\n", passed ? "PASS" : "FAIL", what);
+    if (!passed)
+    {
+        failures++;
+    }
+}
+
+// A vertex whose distance from the traversal's start is -1 must not be taken for an unvisited one
+static void testNegativeWeights()
+{
+    Graph graph(3);
+    graph.addEdge(0, 1, -1);
+    graph.addEdge(1, 2, 5);
+    std::unique_ptr<MSTAlgo> algo(MSTFactory::createMSTAlgorithm(MSTFactory::KRUSKAL));
+    MSTTree tree = algo->computeMST(graph);
+
+    const std::vector<MSTTree::Component> &components = tree.getComponents();
+    check(components.size() == 1 && components[0].vertices == 3 && components[0].weight == 4,
+          "negative weight: one component of 3 vertices and weight 4");
+    check(tree.getLongestDistance() == 5, "negative weight: longest distance 5");
+    // Pairs i <= j: (0,0) 0, (1,1) 0, (2,2) 0, (0,1) -1, (1,2) 5, (0,2) 4
+    check(std::fabs(tree.getAverageDistance() - 8.0 / 6) < 1e-9, "negative weight: average distance 8/6");
+    check(tree.getShortestDistance(0, 2) == 4, "negative weight: distance 0 - 2 is 4");
+}
+
+// Helper function to cut input into commands the way a connection does
+static std::vector<std::string> cutInput(const std::string &input)
+{
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ssize_t written = write(fds[1], input.data(), input.size());
+    (void)written;
+    close(fds[1]);
+
+    std::vector<std::string> commands;
+    Connection connection(fds[0]); // Owns fds[0] from here on
+    connection.readAvailable();
+    connection.queueCommands(false);
+    connection.runCommands([&commands](Connection &, const std::string &command)
+                           { commands.push_back(command); });
+    return commands;
+}
+
+// A frame's line without a record count must not take the count from the next line
+static void testFrameWithoutCount()
+{
+    std::vector<std::string> commands = cutInput("upload 3\n12\nprint\n");
+    check(commands.size() == 3 && commands[0] == "upload 3" && commands[1] == "12" && commands[2] == "print",
+          "upload without an edge count: three separate commands");
+    commands = cutInput("distances x\n1\n");
+    check(commands.size() == 2 && commands[0] == "distances x", "distances with a malformed count: two commands");
+    commands = cutInput(std::string("distances 1\n") + std::string(PAIR_RECORD_SIZE, '\n') + "print\n");
+    check(commands.size() == 2 && commands[0].size() == 12 + PAIR_RECORD_SIZE && commands[1] == "print",
+          "distances with a count: line and payload are one command");
+}
+
+// Helper function to send data through the socket pair end fd while connection reads the other end
+static void feed(Connection &connection, int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t written = write(fd, data.data() + sent, data.size() - sent);
+        if (written > 0)
+        {
+            sent += written;
+        }
+        connection.readAvailable();
+    }
+}
+
+// Frames larger than MAX_BUFFERED_INPUT share one server-wide budget: a frame beyond it is refused
+static void testFrameBudget()
+{
+    int first[2];
+    int second[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, first);
+    socketpair(AF_UNIX, SOCK_STREAM, 0, second);
+    for (int fd : {first[0], first[1], second[0], second[1]})
+    {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+    }
+    std::string frame = "upload 3 " + std::to_string(MAX_UPLOAD_EDGES) + "\n" + std::string(2 * 1024 * 1024, '\0');
+
+    Connection reading(first[0]);
+    Connection refused(second[0]);
+    feed(reading, first[1], frame);
+    feed(refused, second[1], frame); // Two frames of 192 MiB do not fit
+    bool ran = false;
+    refused.queueCommands(false);
+    refused.runCommands([&ran](Connection &, const std::string &) { ran = true; });
+    char reply[128] = {};
+    ssize_t length = read(second[1], reply, sizeof(reply) - 1);
+    check(!ran && refused.isClosing() && length > 0 && std::string(reply).compare(0, 11, "Server busy") == 0,
+          "a frame beyond the budget: refused, connection closed");
+    check(!reading.isClosing(), "a frame within the budget: read on");
+    close(first[1]);
+    close(second[1]);
+}
+
+// A cache hit must come from a graph with the same edges (Graph::hasSameEdges() guards against hash collisions)
+static void testCacheChecksGraph()
+{
+    std::shared_ptr<Graph> sparse = std::make_shared<Graph>(4, Graph::SPARSE);
+    sparse->addEdge(0, 1, 3);
+    sparse->addEdge(1, 2, 4);
+    sparse->addEdge(2, 3, 5);
+    Graph dense(4, Graph::DENSE); // Same edges, other storage and order
+    dense.addEdge(3, 2, 5);
+    dense.addEdge(0, 1, 3);
+    dense.addEdge(2, 1, 4);
+    Graph other(4);
+    other.addEdge(0, 1, 3);
+    other.addEdge(1, 2, 4);
+    other.addEdge(1, 3, 5);
+    check(sparse->hasSameEdges(dense) && dense.hasSameEdges(*sparse), "same edges in either storage");
+    check(!sparse->hasSameEdges(other), "different edges");
+
+    MSTCache cache(1024 * 1024);
+    std::unique_ptr<MSTAlgo> algo(MSTFactory::createMSTAlgorithm(MSTFactory::KRUSKAL));
+    cache.insert(sparse, 0, std::make_shared<MSTTree>(algo->computeMST(*sparse)));
+    check(cache.find(*sparse, 0) != nullptr && cache.find(dense, 0) != nullptr, "cache hit for the same edges");
+    check(cache.find(other, 0) == nullptr, "cache miss for other edges");
+}
+
+// A task spawned on a pool that is shutting down must still run, or waitFor() would never return
+static void testSpawnAfterShutdown()
+{
+    ActiveObject pool(2, ActiveObject::WORK_STEALING);
+    pool.shutdown();
+    std::atomic<int> pending(0);
+    bool ran = false;
+    pool.spawn(pending, [&ran]()
+               { ran = true; });
+    pool.waitFor(pending);
+    check(ran && pending.load() == 0, "spawn on a stopped pool runs the task");
+}
+
+// parallelFor() on a pool, also from inside one of the pool's tasks, must cover every index once
+static void testParallelForOnPool()
+{
+    ActiveObject pool(4, ActiveObject::WORK_STEALING);
+    parallelPool() = &pool;
+    const size_t count = 64 * PARALLEL_MIN_CHUNK;
+    std::vector<std::atomic<int>> visits(count);
+    std::atomic<int> pending(0);
+    pool.spawn(pending, [&]()
+               { parallelFor(8, count, [&](size_t begin, size_t end, int)
+                             {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        visits[i]++;
+                    } }); });
+    pool.waitFor(pending);
+    parallelPool() = nullptr;
+    bool once = true;
+    for (std::atomic<int> &visit : visits)
+    {
+        once = once && visit.load() == 1;
+    }
+    check(once, "parallelFor on a pool visits every index once");
+}
+
+int main()
+{
+    testNegativeWeights();
+    testFrameWithoutCount();
+    testFrameBudget();
+    testCacheChecksGraph();
+    testSpawnAfterShutdown();
+    testParallelForOnPool();
+    std::printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}